@@ -44,6 +44,13 @@ typedef struct {
 
 	zusize cycles;
 
+	/** Cycle budget of the current call to @c z80_run.
+	  * @details Set by @c z80_run. Instructions that execute several
+	  * passes in one go (see @c CPU_Z80_BULK_REPEAT) never start a pass
+	  * at or beyond this limit. */
+
+	zusize cycle_limit;
+
 	/** The value used as the first argument when calling a callback.
 	  * @details This variable should be initialized before using the
 	  * emulator and can be used to reference the context/instance of
@@ -66,10 +66,17 @@ typedef zuint8 (* Instruction)(Z80 *object);
 
 /* MARK: - Macros & Functions: Callback */
 
-#define READ_8(address)		object->read	(object->context, (zuint16)(address))
-#define WRITE_8(address, value) object->write	(object->context, (zuint16)(address), (zuint8)(value))
-#define IN(port)		object->in	(object->context, (zuint16)(port   ))
-#define OUT(port, value)	object->out	(object->context, (zuint16)(port   ), (zuint8)(value))
+/* A file that includes this one can predefine CPU_Z80_CUSTOM_CALLBACKS and
+   its own READ_8, WRITE_8, IN and OUT macros to bind the core to a concrete
+   bus at compile time instead of going through the callback pointers. */
+
+#ifndef CPU_Z80_CUSTOM_CALLBACKS
+#	define READ_8(address)		object->read	(object->context, (zuint16)(address))
+#	define WRITE_8(address, value)	object->write	(object->context, (zuint16)(address), (zuint8)(value))
+#	define IN(port)			object->in	(object->context, (zuint16)(port   ))
+#	define OUT(port, value)		object->out	(object->context, (zuint16)(port   ), (zuint8)(value))
+#endif
+
 #define INT_DATA		object->int_data(object->context)
 #define READ_OFFSET(address)	((zsint8)READ_8(address))
 #define SET_HALT		if (object->halt != NULL) object->halt(object->context, TRUE )
@@ -129,6 +136,7 @@ static Z_INLINE void write_16bit(Z80 *object, zuint16 address, zuint16 value)
 /* MARK: - Macros: Temporal Data */
 
 #define CYCLES	    object->cycles
+#define CYCLE_LIMIT object->cycle_limit
 #define R7	    object->r7
 #define BYTE(index) object->data.array_uint8[index]
 #define BYTE0	    BYTE(0)
@@ -216,6 +224,7 @@ VF(adc,  8, zsint,   +,   -128,   127)
 VF(sbc,  8, zsint,   -,   -128,   127)
 VF(adc, 16, zsint32, +, -32768, 32767)
 VF(sbc, 16, zsint32, -, -32768, 32767)
+#undef	VF
 
 
 /* MARK: - 8-Bit Register Resolution
@@ -653,9 +662,65 @@ static Z_INLINE zuint8 _m______(Z80 *object, zuint8 offset, zuint8 value)
 		 | (!!(--BC) << 2));  /* PF = 1 if BC != 0, else PF = 0 */
 
 
-#define LDXR(operator)	    \
-	LDX(operator)	    \
-	if (!BC) return 16; \
+/*-------------------------------------------------------------------------.
+| With CPU_Z80_BULK_REPEAT the repeating block instructions run their next |
+| passes inside one call instead of going back through the run loop. Each  |
+| pass is accounted exactly as the loop would do it (21 cycles, R += 2,    |
+| same CYCLES seen by callbacks), and the bulk stops as soon as the loop   |
+| would behave differently: cycle budget reached, an interrupt pending, or |
+| the opcode at PC changed (self-modification or paging). The I/O variants |
+| also require BULK_IO_SAFE(port), which the including file may define.    |
+'-------------------------------------------------------------------------*/
+
+#ifdef CPU_Z80_BULK_REPEAT
+#	define BULK_REPEAT(body, finished, allowed)			\
+		while (	CYCLES + 21 < CYCLE_LIMIT			\
+			&& !NMI && !(INT && IFF1)			\
+			&& READ_8(PC - 2) == BYTE0			\
+			&& READ_8(PC - 1) == BYTE1			\
+			&& (allowed)					\
+		)							\
+			{						\
+			CYCLES += 21;					\
+			R += 2;						\
+			PC -= 2;					\
+			{body if (finished) return 16;}			\
+			}
+#else
+#	define BULK_REPEAT(body, finished, allowed)
+#endif
+
+#ifndef BULK_IO_SAFE
+#	define BULK_IO_SAFE(port) FALSE
+#endif
+
+
+/*-------------------------------------------------------------------------.
+| With CPU_Z80_HALT_SKIP a halted CPU does not spin through 4-cycle passes |
+| until the end of the call: the passes that would start before the cycle  |
+| budget are accounted at once (CYCLES += 4n, R += n). Interrupts are only |
+| raised between calls to z80_run, so the next one is the one that wakes   |
+| the CPU up. If an interrupt is already pending nothing is skipped.       |
+'-------------------------------------------------------------------------*/
+
+#ifdef CPU_Z80_HALT_SKIP
+#	define HALT_SKIP						\
+		if (!NMI && !(INT && IFF1) && CYCLES + 4 < CYCLE_LIMIT)	\
+			{						\
+			zusize n = (CYCLE_LIMIT - CYCLES - 1) / 4;	\
+									\
+			CYCLES += n * 4;				\
+			R += (zuint8)n;					\
+			}
+#else
+#	define HALT_SKIP
+#endif
+
+
+#define LDXR(operator)				   \
+	LDX(operator)				   \
+	if (!BC) return 16;			   \
+	BULK_REPEAT(LDX(operator), !BC, TRUE)	   \
 	PC -= 2; return 21;
 
 
@@ -676,9 +741,10 @@ static Z_INLINE zuint8 _m______(Z80 *object, zuint8 offset, zuint8 value)
 		 | F_C);	       /* CF unchanged		 */
 
 
-#define CPXR(operator)		   \
-	CPX(operator)		   \
-	if (!BC || !n0) return 16; \
+#define CPXR(operator)				       \
+	CPX(operator)				       \
+	if (!BC || !n0) return 16;		       \
+	BULK_REPEAT(CPX(operator), !BC || !n0, TRUE)   \
 	PC -= 2;	return 21;
 
 
@@ -786,9 +852,10 @@ static Z_INLINE void add_RR_NN(Z80 *object, zuint16 *r, zuint16 v)
 	if (t > 255) F |= HCF;		  /* if (([HL] + ((C +/- 1) & 255)) > 255) HF = 1; else HF = 0 */
 
 
-#define INXR(hl_operator, c_operator) \
-	INX(hl_operator, c_operator); \
-	if (!B)	 return 16;	      \
+#define INXR(hl_operator, c_operator)					  \
+	INX(hl_operator, c_operator);					  \
+	if (!B)	 return 16;						  \
+	BULK_REPEAT(INX(hl_operator, c_operator);, !B, BULK_IO_SAFE(BC))  \
 	PC -= 2; return 21;
 
 
@@ -809,9 +876,10 @@ static Z_INLINE void add_RR_NN(Z80 *object, zuint16 *r, zuint16 v)
 	if ((zuint)t + L > 255) F |= HCF;	/* if (L + [HL] > 255) CF = 1; else CF = 0	  */
 
 
-#define OTXR(operator)	    \
-	OUTX(operator);	    \
-	if (!B)	 return 16; \
+#define OTXR(operator)					     \
+	OUTX(operator);					     \
+	if (!B)	 return 16;				     \
+	BULK_REPEAT(OUTX(operator);, !B, BULK_IO_SAFE(BC))   \
 	PC -= 2; return 21;
 
 
@@ -1015,7 +1083,7 @@ INSTRUCTION(V_vXYOFFSET)   {zuint16 a = (zuint16)(XY + READ_OFFSET((PC += 3) - 1
 '--------------------------------------------------------------------------*/
 
 INSTRUCTION(nop)  {PC++;			     return 4;}
-INSTRUCTION(halt) {HALT = 1; SET_HALT;		     return 4;}
+INSTRUCTION(halt) {if (!HALT) {HALT = 1; SET_HALT;} HALT_SKIP return 4;}
 INSTRUCTION(di)	  {PC++; IFF1 = IFF2 = 0; EI = TRUE; return 4;}
 INSTRUCTION(ei)	  {PC++; IFF1 = IFF2 = 1; EI = TRUE; return 4;}
 INSTRUCTION(im_0) {PC += 2; IM = 0;		     return 8;}
@@ -1481,14 +1549,211 @@ CPU_Z80_API void z80_reset(Z80 *object)
 	}
 
 
-CPU_Z80_API zusize z80_run(Z80 *object, zusize cycles)
+/*------------------------------------------------------------------.
+| Interrupt acceptance, shared by the switch and threaded run loops |
+'------------------------------------------------------------------*/
+
+static zuint8 accept_nmi(Z80 *object)
+	{
+	EXIT_HALT;			/* Resume CPU if halted.				   */
+	R++;				/* Consume memory refresh.				   */
+	NMI = FALSE;			/* Clear the NMI pulse.					   */
+	/*IFF2 = IFF1;*/		/* Backup IFF1 (it doesn't occur, acording to Sean Young). */
+	IFF1 = 0;			/* Reset IFF1 to don't bother the NMI routine.		   */
+	PUSH(PC);			/* Save return addres in the stack.			   */
+	PC = Z_Z80_ADDRESS_NMI_POINTER;	/* Make PC point to the NMI routine.			   */
+	return 11;			/* Accepting a NMI consumes 11 cycles.			   */
+	}
+
+
+static zuint8 accept_int(Z80 *object)
 	{
 	zuint32 data;
 
+	EXIT_HALT;	 /* Resume CPU on halt.		*/
+	R++;		 /* Consume memory refresh.	*/
+	IFF1 = IFF2 = 0; /* Clear interrupt flip-flops.	*/
+
+	switch (IM)
+		{
+		/*------------------------------.
+		| IM 0: Execute bus instruction |
+		'------------------------------*/
+		case 0:
+
+		if ((data = INT_DATA)) switch (data & Z_UINT32(0xFF000000))
+			{
+			case Z_UINT32(0xC3000000): /* JP */
+			PC = (zuint16)(data >> 8);
+			return 10 + 2;
+
+			case Z_UINT32(0xCD000000): /* CALL */
+			PUSH(PC);
+			PC = (zuint16)(data >> 8);
+			return 17 + 2;
+
+			default: /* RST (and possibly others) */
+			PUSH(PC);
+			PC = (zuint16)((data >> 8) & 0x38);
+			return 11 + 2;
+			}
+
+		return 2;
+
+		/*----------------------.
+		| IM 1: Execute rst 38h |
+		'----------------------*/
+		case 1:
+		PUSH(PC);
+		PC = 0x38;
+		return 11 + 2;
+
+		/*---------------------------.
+		| IM 2: Execute rst [i:byte] |
+		'---------------------------*/
+		default:
+		PUSH(PC);
+		PC = READ_16(((zuint16)(I << 8)) | (INT_DATA & 0xFF));
+		return 17 + 2;
+		}
+	}
+
+
+#if defined(CPU_Z80_THREADED_DISPATCH) && defined(__GNUC__)
+
+/*--------------------------------------------------------------------------.
+| Threaded run loop: every unprefixed opcode has its own label, which calls |
+| the instruction function directly (so the compiler can inline it) and     |
+| then jumps straight to the label of the next opcode. The cycle counter    |
+| lives in a local and is published to CYCLES before each instruction, so   |
+| callbacks still see the current cycle.                                    |
+'--------------------------------------------------------------------------*/
+
+#	define T(name) &&t_##name
+
+#	define DISPATCH						 \
+		if ((CYCLES = c) >= cycles) goto done;		 \
+		if (NMI) goto nmi;					 \
+		if (INT && IFF1 && !EI) goto irq;			 \
+		R++;							 \
+		EI = FALSE;						 \
+		goto *threaded_table[BYTE0 = READ_8(PC)];
+
+#	define THREAD(name) t_##name: c += name(object); DISPATCH
+
+	/* HALT and ED (and DD/FD, which may fall through to it) can add the  */
+	/* cycles of skipped or bulk passes to CYCLES directly, and so can    */
+	/* the port callback of IN A,(n) (accelerated tape loaders).	      */
+#	define THREAD_SYNC(name) t_##name: c = name(object); c += CYCLES; DISPATCH
+
+CPU_Z80_API zusize z80_run(Z80 *object, zusize cycles)
+	{
+	static void const *const threaded_table[256] = {
+		/* 0 */ T(nop), T(ld_SS_WORD), T(ld_vbc_a), T(inc_SS), T(V_X), T(V_X), T(ld_X_BYTE), T(rlca), T(ex_af_af_), T(add_hl_SS), T(ld_a_vbc), T(dec_SS), T(V_X), T(V_X), T(ld_X_BYTE), T(rrca),
+		/* 1 */ T(djnz_OFFSET), T(ld_SS_WORD), T(ld_vde_a), T(inc_SS), T(V_X), T(V_X), T(ld_X_BYTE), T(rla), T(jr_OFFSET), T(add_hl_SS), T(ld_a_vde), T(dec_SS), T(V_X), T(V_X), T(ld_X_BYTE), T(rra),
+		/* 2 */ T(jr_Z_OFFSET), T(ld_SS_WORD), T(ld_vWORD_hl), T(inc_SS), T(V_X), T(V_X), T(ld_X_BYTE), T(daa), T(jr_Z_OFFSET), T(add_hl_SS), T(ld_hl_vWORD), T(dec_SS), T(V_X), T(V_X), T(ld_X_BYTE), T(cpl),
+		/* 3 */ T(jr_Z_OFFSET), T(ld_SS_WORD), T(ld_vWORD_a), T(inc_SS), T(V_vhl), T(V_vhl), T(ld_vhl_BYTE), T(scf), T(jr_Z_OFFSET), T(add_hl_SS), T(ld_a_vWORD), T(dec_SS), T(V_X), T(V_X), T(ld_X_BYTE), T(ccf),
+		/* 4 */ T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_vhl), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_vhl), T(ld_X_Y),
+		/* 5 */ T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_vhl), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_vhl), T(ld_X_Y),
+		/* 6 */ T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_vhl), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_vhl), T(ld_X_Y),
+		/* 7 */ T(ld_vhl_Y), T(ld_vhl_Y), T(ld_vhl_Y), T(ld_vhl_Y), T(ld_vhl_Y), T(ld_vhl_Y), T(halt), T(ld_vhl_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_Y), T(ld_X_vhl), T(ld_X_Y),
+		/* 8 */ T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_vhl), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_vhl), T(U_a_Y),
+		/* 9 */ T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_vhl), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_vhl), T(U_a_Y),
+		/* A */ T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_vhl), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_vhl), T(U_a_Y),
+		/* B */ T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_vhl), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_Y), T(U_a_vhl), T(U_a_Y),
+		/* C */ T(ret_Z), T(pop_TT), T(jp_Z_WORD), T(jp_WORD), T(call_Z_WORD), T(push_TT), T(U_a_BYTE), T(rst_N), T(ret_Z), T(ret), T(jp_Z_WORD), T(CB), T(call_Z_WORD), T(call_WORD), T(U_a_BYTE), T(rst_N),
+		/* D */ T(ret_Z), T(pop_TT), T(jp_Z_WORD), T(out_vBYTE_a), T(call_Z_WORD), T(push_TT), T(U_a_BYTE), T(rst_N), T(ret_Z), T(exx), T(jp_Z_WORD), T(in_a_BYTE), T(call_Z_WORD), T(DD), T(U_a_BYTE), T(rst_N),
+		/* E */ T(ret_Z), T(pop_TT), T(jp_Z_WORD), T(ex_vsp_hl), T(call_Z_WORD), T(push_TT), T(U_a_BYTE), T(rst_N), T(ret_Z), T(jp_hl), T(jp_Z_WORD), T(ex_de_hl), T(call_Z_WORD), T(ED), T(U_a_BYTE), T(rst_N),
+		/* F */ T(ret_Z), T(pop_TT), T(jp_Z_WORD), T(di), T(call_Z_WORD), T(push_TT), T(U_a_BYTE), T(rst_N), T(ret_Z), T(ld_sp_hl), T(jp_Z_WORD), T(ei), T(call_Z_WORD), T(FD), T(U_a_BYTE), T(rst_N)
+	};
+
+	zusize c = 0;
+
+	CYCLE_LIMIT = cycles;
+	R7 = R;
+	DISPATCH
+
+	nmi: c += accept_nmi(object); DISPATCH
+	irq: c += accept_int(object); DISPATCH
+
+	THREAD(nop)
+	THREAD(ld_SS_WORD)
+	THREAD(ld_vbc_a)
+	THREAD(inc_SS)
+	THREAD(V_X)
+	THREAD(ld_X_BYTE)
+	THREAD(rlca)
+	THREAD(ex_af_af_)
+	THREAD(add_hl_SS)
+	THREAD(ld_a_vbc)
+	THREAD(dec_SS)
+	THREAD(rrca)
+	THREAD(djnz_OFFSET)
+	THREAD(ld_vde_a)
+	THREAD(rla)
+	THREAD(jr_OFFSET)
+	THREAD(ld_a_vde)
+	THREAD(rra)
+	THREAD(jr_Z_OFFSET)
+	THREAD(ld_vWORD_hl)
+	THREAD(daa)
+	THREAD(ld_hl_vWORD)
+	THREAD(cpl)
+	THREAD(ld_vWORD_a)
+	THREAD(V_vhl)
+	THREAD(ld_vhl_BYTE)
+	THREAD(scf)
+	THREAD(ld_a_vWORD)
+	THREAD(ccf)
+	THREAD(ld_X_Y)
+	THREAD(ld_X_vhl)
+	THREAD(ld_vhl_Y)
+	THREAD_SYNC(halt)
+	THREAD(U_a_Y)
+	THREAD(U_a_vhl)
+	THREAD(ret_Z)
+	THREAD(pop_TT)
+	THREAD(jp_Z_WORD)
+	THREAD(jp_WORD)
+	THREAD(call_Z_WORD)
+	THREAD(push_TT)
+	THREAD(U_a_BYTE)
+	THREAD(rst_N)
+	THREAD(ret)
+	THREAD(CB)
+	THREAD(call_WORD)
+	THREAD(out_vBYTE_a)
+	THREAD(exx)
+	THREAD_SYNC(in_a_BYTE)
+	THREAD_SYNC(DD)
+	THREAD(ex_vsp_hl)
+	THREAD(jp_hl)
+	THREAD(ex_de_hl)
+	THREAD_SYNC(ED)
+	THREAD(di)
+	THREAD(ld_sp_hl)
+	THREAD(ei)
+	THREAD_SYNC(FD)
+
+	done:
+	R = R_ALL;
+	return CYCLES;
+	}
+
+#	undef THREAD_SYNC
+#	undef THREAD
+#	undef DISPATCH
+#	undef T
+
+#else
+
+CPU_Z80_API zusize z80_run(Z80 *object, zusize cycles)
+	{
 	/*-------------.
 	| Clear cycles |
 	'-------------*/
 	CYCLES = 0;
+	CYCLE_LIMIT = cycles;
 
 	/*--------------.
 	| Backup R7 bit |
@@ -1505,14 +1770,7 @@ CPU_Z80_API zusize z80_run(Z80 *object, zusize cycles)
 		'--------------------------------------*/
 		if (NMI)
 			{
-			EXIT_HALT;			/* Resume CPU if halted.				   */
-			R++;				/* Consume memory refresh.				   */
-			NMI = FALSE;			/* Clear the NMI pulse.					   */
-			/*IFF2 = IFF1;*/		/* Backup IFF1 (it doesn't occur, acording to Sean Young). */
-			IFF1 = 0;			/* Reset IFF1 to don't bother the NMI routine.		   */
-			PUSH(PC);			/* Save return addres in the stack.			   */
-			PC = Z_Z80_ADDRESS_NMI_POINTER;	/* Make PC point to the NMI routine.			   */
-			CYCLES += 11;			/* Accepting a NMI consumes 11 cycles.			   */
+			CYCLES += accept_nmi(object);
 			continue;
 			}
 
@@ -1521,58 +1779,7 @@ CPU_Z80_API zusize z80_run(Z80 *object, zusize cycles)
 		'--------------------------*/
 		if (INT && IFF1 && !EI)
 			{
-			EXIT_HALT;	 /* Resume CPU on halt.		*/
-			R++;		 /* Consume memory refresh.	*/
-			IFF1 = IFF2 = 0; /* Clear interrupt flip-flops.	*/
-
-			switch (IM)
-				{
-				/*------------------------------.
-				| IM 0: Execute bus instruction |
-				'------------------------------*/
-				case 0:
-
-				if ((data = INT_DATA)) switch (data & Z_UINT32(0xFF000000))
-					{
-					case Z_UINT32(0xC3000000): /* JP */
-					PC = (zuint16)(data >> 8);
-					CYCLES += 10;
-					break;
-
-					case Z_UINT32(0xCD000000): /* CALL */
-					PUSH(PC);
-					PC = (zuint16)(data >> 8);
-					CYCLES += 17;
-					break;
-
-					default: /* RST (and possibly others) */
-					PUSH(PC);
-					PC = (zuint16)((data >> 8) & 0x38);
-					CYCLES += 11;
-					}
-
-				CYCLES += 2;
-				break;
-
-				/*----------------------.
-				| IM 1: Execute rst 38h |
-				'----------------------*/
-				case 1:
-				PUSH(PC);
-				PC = 0x38;
-				CYCLES += (11 + 2);
-				break;
-
-				/*---------------------------.
-				| IM 2: Execute rst [i:byte] |
-				'---------------------------*/
-				case 2:
-				PUSH(PC);
-				PC = READ_16(((zuint16)(I << 8)) | (INT_DATA & 0xFF));
-				CYCLES += (17 + 2);
-				break;
-				}
-
+			CYCLES += accept_int(object);
 			continue;
 			}
 
@@ -1599,6 +1806,8 @@ CPU_Z80_API zusize z80_run(Z80 *object, zusize cycles)
 	return CYCLES;
 	}
 
+#endif
+
 
 CPU_Z80_API void z80_nmi(Z80 *object)		      {NMI = TRUE ;}
 CPU_Z80_API void z80_int(Z80 *object, zboolean state) {INT = state;}
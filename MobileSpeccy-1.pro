@@ -1,70 +1,25 @@
-QT       += core gui
+# core      - libspeccy, эмуляция без виджетов (core/core.pro)
+# app       - GUI на QtWidgets
+# cli       - запуск без окна (speccy-cli), на Android не собирается
+# benchmarks - замеры скорости ядра, на Android не собираются
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+TEMPLATE = subdirs
 
-CONFIG += c++17
+SUBDIRS += \
+    core \
+    app
 
-# You can make your code fail to compile if it uses deprecated APIs.
-# In order to do so, uncomment the following line.
-#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+app.depends = core
 
-SOURCES += \
-    busdevice.cpp \
-    businterface.cpp \
-    businterface128.cpp \
-    businterface48.cpp \
-    keyboardwidget.cpp \
-    main.cpp \
-    mainwindow.cpp \
-    port1f.cpp \
-    port7ffd.cpp \
-    portfe.cpp \
-    ramdevice.cpp \
-    romdevice.cpp \
-    screenwidget.cpp \
-    3rdparty/Z80/sources/Z80.c \
-    zxpushbutton.cpp
+!android {
+    cli.depends = core
+    SUBDIRS += cli
 
-HEADERS += \
-    busdevice.h \
-    businterface.h \
-    businterface128.h \
-    businterface48.h \
-    keyboardwidget.h \
-    mainwindow.h \
-    port1f.h \
-    port7ffd.h \
-    portfe.h \
-    ramdevice.h \
-    romdevice.h \
-    screenwidget.h \
-    3rdparty/Z80/API/emulation/CPU/Z80.h \
-    zxpushbutton.h
+    bench_z80core.subdir = benchmarks/z80core
+    bench_z80core.depends = core
+    SUBDIRS += bench_z80core
 
-FORMS += \
-    mainwindow.ui
-
-OTHER_FILES += \
-    rom/* \
-    sna/*
-
-INCLUDEPATH +=\
-    3rdparty/Z/API \
-    3rdparty/Z80/API
-
-DEFINES += \
-        CPU_Z80_STATIC
-
-android
-{
-my_files.path = /assets
-my_files.files = $$PWD/assets/*
-INSTALLS += my_files
-OTHER_FILES += \
-    rom/*
+    bench_suite.subdir = benchmarks/suite
+    bench_suite.depends = core
+    SUBDIRS += bench_suite
 }
-
-# Default rules for deployment.
-qnx: target.path = /tmp/$${TARGET}/bin
-else: unix:!android: target.path = /opt/$${TARGET}/bin
-!isEmpty(target.path): INSTALLS += target
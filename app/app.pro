@@ -0,0 +1,56 @@
+QT       += core gui
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets multimedia
+
+CONFIG += c++17
+
+TARGET = MobileSpeccy-1
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+include(../core/core.pri)
+
+SOURCES += \
+    audiooutput.cpp \
+    emulationthread.cpp \
+    keyboardwidget.cpp \
+    main.cpp \
+    mainwindow.cpp \
+    screenrenderer.cpp \
+    screenwidget.cpp \
+    zxpushbutton.cpp
+
+HEADERS += \
+    audiooutput.h \
+    emulationthread.h \
+    keyboardwidget.h \
+    mainwindow.h \
+    screenrenderer.h \
+    screenwidget.h \
+    zxpushbutton.h
+
+# timeBeginPeriod: точный сон потока эмуляции
+win32: LIBS += -lwinmm
+
+FORMS += \
+    mainwindow.ui
+
+OTHER_FILES += \
+    ../rom/* \
+    ../sna/*
+
+android
+{
+my_files.path = /assets
+my_files.files = $$PWD/../assets/*
+INSTALLS += my_files
+OTHER_FILES += \
+    ../rom/*
+}
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,75 @@
+#include "audiooutput.h"
+#include <QAudioDeviceInfo>
+#include <QAudioOutput>
+#include <QDebug>
+
+AudioOutput::AudioOutput(AudioStream *stream, QObject *parent)
+    : QIODevice(parent)
+    , _stream(stream)
+{
+}
+
+AudioOutput::~AudioOutput()
+{
+    stop();
+}
+
+int AudioOutput::start()
+{
+    QAudioDeviceInfo device = QAudioDeviceInfo::defaultOutputDevice();
+    QAudioFormat format;
+    format.setChannelCount(1);
+    format.setSampleSize(16);
+    format.setSampleType(QAudioFormat::SignedInt);
+    format.setByteOrder(QAudioFormat::Endian(QSysInfo::ByteOrder));
+    format.setCodec("audio/pcm");
+
+    int rate = 0;
+    for (int candidate : { 48000, 44100 }) {
+        format.setSampleRate(candidate);
+        if (device.isFormatSupported(format)) {
+            rate = candidate;
+            break;
+        }
+    }
+    if (not rate) {
+        qWarning() << "No audio output for 16 bit mono at 48000/44100 Hz";
+        return 0;
+    }
+
+    _stream->set_sample_rate(rate);
+    _output = new QAudioOutput(device, format, this);
+    _output->setBufferSize(rate * BUFFER_MS / 1000 * int(sizeof(int16_t)));
+    open(QIODevice::ReadOnly);
+    _output->start(this);
+    return rate;
+}
+
+void AudioOutput::stop()
+{
+    if (not _output)
+        return;
+    _output->stop();
+    close();
+    delete _output;
+    _output = nullptr;
+}
+
+qint64 AudioOutput::readData(char *data, qint64 max)
+{
+    int16_t *samples = reinterpret_cast<int16_t *>(data);
+    int count = int(max / qint64(sizeof(int16_t)));
+    int got = _stream->read(samples, count);
+    if (got)
+        _last = samples[got - 1];
+    for (int i = got; i < count; i++)
+        samples[i] = _last;
+    return qint64(count) * qint64(sizeof(int16_t));
+}
+
+qint64 AudioOutput::writeData(const char *data, qint64 size)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+    return -1;
+}
@@ -0,0 +1,40 @@
+#ifndef AUDIOOUTPUT_H
+#define AUDIOOUTPUT_H
+
+#include <QIODevice>
+#include "audiostream.h"
+
+class QAudioOutput;
+
+// Звук на устройство по умолчанию (QAudioOutput, режим pull).
+// Устройство само забирает сэмплы из EmulationThread::audio() в своём
+// темпе; чего там нет (пока копится задержка, после опустошения),
+// дополняется последним сэмплом - тишиной без щелчка.
+class AudioOutput : public QIODevice
+{
+    Q_OBJECT
+public:
+    static constexpr int BUFFER_MS = 40;    // буфер устройства
+
+    explicit AudioOutput(AudioStream *stream, QObject *parent = nullptr);
+    ~AudioOutput() override;
+
+    // Открыть устройство: 48000 или 44100 Гц, моно, 16 бит. Возвращает
+    // частоту (она же передана в stream), 0 - устройства или подходящего
+    // формата нет
+    int start();
+    void stop();
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 max) override;
+    qint64 writeData(const char *data, qint64 size) override;
+
+private:
+    AudioStream *_stream;
+    QAudioOutput *_output { nullptr };
+    int16_t _last { 0 };
+};
+
+#endif // AUDIOOUTPUT_H
@@ -0,0 +1,108 @@
+#include "emulationthread.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+EmulationThread::EmulationThread(FrameQueue *frames, std::function<void ()> published,
+                                 QObject *parent)
+    : QThread(parent)
+    , _frames(frames)
+    , _published(std::move(published))
+{
+    // Поток ещё не запущен: очередь ошибок пока пишет GUI
+    if (not _machine.error().isEmpty())
+        _errors.push(_machine.error());
+}
+
+EmulationThread::~EmulationThread()
+{
+    stop();
+}
+
+bool EmulationThread::post(const Command &command)
+{
+    return _commands.push(command);
+}
+
+void EmulationThread::stop()
+{
+    if (not isRunning())
+        return;
+    _stop = true;
+    wait();
+}
+
+void EmulationThread::run()
+{
+#if defined(Q_OS_WIN)
+    // Без этого сон в FramePacer квантуется по 15.6 мс
+    timeBeginPeriod(1);
+#endif
+    _pacer.set_rate(_machine.bus()->timing().frame_rate());
+    bool turbo = false;
+    FramePacer::Clock::time_point shown = FramePacer::Clock::now();
+    while (not _stop) {
+        bool was_turbo = turbo;
+        turbo = _tape_turbo and _machine.tape_loading();
+        if (not turbo) {
+            if (was_turbo)
+                _pacer.restart();
+            _pacer.wait();
+        }
+        FramePacer::Clock::time_point now = FramePacer::Clock::now();
+
+        Command command;
+        while (_commands.pop(command))
+            execute(command);
+        // После команд: reset и смена модели чистят планировщик
+        _input.schedule(_machine, now, _pacer.period());
+
+        _machine.run_frame();
+        if (not turbo) {
+            _audio.write(_machine.audio().data(), int(_machine.audio().size()));
+            _machine.set_rate_adjust(_audio.rate_adjust());
+        } else if (now - shown < _pacer.period()) {
+            continue;
+        }
+        shown = now;
+        _machine.capture_frame(_frames->production_frame());
+        _frames->publish();
+        if (_published)
+            _published();
+    }
+#if defined(Q_OS_WIN)
+    timeEndPeriod(1);
+#endif
+}
+
+void EmulationThread::execute(const Command &command)
+{
+    BusInterface *bus = _machine.bus();
+    bool ok = true;
+    switch (command.type) {
+    case Command::RESET:       _machine.reset(); break;
+    case Command::NMI:         _machine.nmi(); break;
+    case Command::SET_PALETTE: bus->_color_pal = command.a; break;
+    case Command::SET_SAMPLE_RATE: _machine.set_sample_rate(command.a); break;
+    case Command::SET_MODEL:
+        ok = _machine.set_model(Machine::Model(command.a));
+        _pacer.set_rate(_machine.bus()->timing().frame_rate());
+        break;
+    case Command::LOAD_SNA: ok = _machine.load_sna(command.file); break;
+    case Command::LOAD_Z80: ok = _machine.load_z80(command.file); break;
+    case Command::SAVE_Z80: ok = _machine.save_z80(command.file); break;
+    case Command::LOAD_SCR: ok = _machine.load_scr(command.file); break;
+    case Command::SAVE_SCR: ok = _machine.save_scr(command.file); break;
+    case Command::TAPE_OPEN: ok = _machine.load_tape(command.file); break;
+    case Command::TAPE_PLAY: _machine.tape().play(); break;
+    case Command::TAPE_STOP: _machine.tape().stop(); break;
+    case Command::TAPE_REWIND: _machine.tape().rewind(); break;
+    case Command::TAPE_TRAPS: _machine.set_tape_traps(command.a); break;
+    case Command::TAPE_TURBO: _tape_turbo = command.a; break;
+    case Command::TAPE_RECORD: ok = _machine.record_tape(command.file); break;
+    case Command::TAPE_RECORD_STOP: ok = _machine.stop_recording(); break;
+    }
+    if (not ok)
+        _errors.push(_machine.error());
+}
@@ -0,0 +1,105 @@
+#ifndef EMULATIONTHREAD_H
+#define EMULATIONTHREAD_H
+
+#include <QThread>
+#include <QString>
+#include <atomic>
+#include <functional>
+#include "audiostream.h"
+#include "framepacer.h"
+#include "framequeue.h"
+#include "inputqueue.h"
+#include "machine.h"
+#include "ringqueue.h"
+
+// Поток эмуляции: владеет Machine, гонит кадры в темпе модели
+// (FramePacer: 50.08 Гц у 48К) и публикует их в FrameQueue. С GUI
+// связан только очередями без блокировок: команды приходят через
+// post(), клавиши и джойстик - через input() (InputQueue, с привязкой
+// к тактам кадра), ошибки команд забираются take_error(), кадры уходят
+// через FrameQueue, звук - через AudioStream с подстройкой темпа под
+// устройство. Диалоги, перерисовка и изменение размера окна
+// кадры не задерживают.
+//
+// Пока загрузчик читает ленту (Machine::tape_loading), включается турбо
+// (TAPE_TURBO): кадры идут подряд без FramePacer, звук в устройство не
+// уходит, а в FrameQueue публикуется один кадр за период модели. Лента
+// остановилась или программа перестала её читать (игра после загрузки
+// с лентой, которая ещё играет) - темп и звук возвращаются сами.
+class EmulationThread : public QThread
+{
+    Q_OBJECT
+public:
+    struct Command
+    {
+        enum Type {
+            RESET,
+            NMI,
+            SET_MODEL,      // a - Machine::Model
+            SET_PALETTE,    // a - BusInterface::_color_pal
+            SET_SAMPLE_RATE, // a - Гц
+            LOAD_SNA,       // file
+            LOAD_Z80,
+            SAVE_Z80,
+            LOAD_SCR,
+            SAVE_SCR,
+            TAPE_OPEN,      // file
+            TAPE_PLAY,
+            TAPE_STOP,
+            TAPE_REWIND,
+            TAPE_TRAPS,     // a - мгновенная загрузка (Machine::set_tape_traps)
+            TAPE_TURBO,     // a - турбо, пока загрузчик читает ленту
+            TAPE_RECORD,    // file - .tap, .tzx или .csw
+            TAPE_RECORD_STOP
+        };
+        Type type { RESET };
+        int a { 0 };
+        int b { 0 };
+        QString file;
+    };
+
+    static constexpr int COMMAND_QUEUE = 256;
+    static constexpr int ERROR_QUEUE = 16;
+
+    // published вызывается из потока эмуляции после каждого кадра
+    explicit EmulationThread(FrameQueue *frames, std::function<void ()> published,
+                             QObject *parent = nullptr);
+    ~EmulationThread() override;
+
+    // Из GUI. false - очередь полна, команда не принята
+    bool post(const Command &command);
+    bool post(Command::Type type, int a = 0, int b = 0) { return post({ type, a, b, QString() }); }
+    bool post(Command::Type type, const QString &file) { return post({ type, 0, 0, file }); }
+
+    // Из GUI: клавиша или кнопка джойстика. false - очередь полна
+    bool input(InputEvent::Type type, int a, int b = 0) { return _input.push(type, a, b); }
+
+    // Ошибка последних команд (Machine::error()), false - ошибок нет
+    bool take_error(QString &error) { return _errors.pop(error); }
+
+    void stop();
+
+    const FramePacer & pacer() const { return _pacer; }
+    const InputQueue & input_queue() const { return _input; }
+    // Сэмплы для звукового устройства (AudioOutput)
+    AudioStream & audio() { return _audio; }
+
+protected:
+    void run() override;
+
+private:
+    void execute(const Command &command);
+
+    FrameQueue *_frames;
+    std::function<void ()> _published;
+    Machine _machine;
+    FramePacer _pacer;
+    RingQueue<Command, COMMAND_QUEUE> _commands;
+    InputQueue _input;
+    AudioStream _audio;
+    RingQueue<QString, ERROR_QUEUE> _errors;
+    std::atomic<bool> _stop { false };
+    bool _tape_turbo { true };
+};
+
+#endif // EMULATIONTHREAD_H
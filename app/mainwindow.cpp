@@ -0,0 +1,557 @@
+#include "mainwindow.h"
+#include "ui_mainwindow.h"
+
+#include <QFile>
+#include <QMessageBox>
+#include <QFileDialog>
+#include <QDebug>
+#include <QKeyEvent>
+#include <QMap>
+#include <cstdint>
+#include <stdint.h>
+
+#include "screenwidget.h"
+#include "screenrenderer.h"
+#include "emulationthread.h"
+#include "audiooutput.h"
+
+
+enum {
+    CURSOR_IF = 0,
+    KEMPSTON_IF = 1,
+    SINCLAIR_IF2 =2,
+    SINCLAIR_IF2_2 =3,
+};
+
+static constexpr int PAIR(int a, int b) { return a * 100 + b;}
+static constexpr int FIRST(int v) { return v / 100;}
+static constexpr int SECOND(int v) { return v % 100;}
+
+static constexpr int ESC_SCANCODE = 1;
+static constexpr int F12_SCANCODE = 88;
+
+static constexpr int UP_SCANCODE = 328;
+static constexpr int DOWN_SCANCODE = 336;
+static constexpr int LEFT_SCANCODE = 331;
+static constexpr int RIGHT_SCANCODE = 333;
+static constexpr int UP2_SCANCODE = 72;
+static constexpr int DOWN2_SCANCODE = 76;
+static constexpr int LEFT2_SCANCODE = 75;
+static constexpr int RIGHT2_SCANCODE = 77;
+static constexpr int LCTRL_SCANCODE = 29;
+static constexpr int RCTRL_SCANCODE = 285;
+
+
+
+
+
+static const QMap<int, int> s_key_mapping
+{
+    { 2,  PAIR(0, 11) },
+    { 3,  PAIR(1, 11) },
+    { 4,  PAIR(2, 11) },
+    { 5,  PAIR(3, 11) },
+    { 6,  PAIR(4, 11) },
+    { 7,  PAIR(4, 12) },
+    { 8,  PAIR(3, 12) },
+    { 9,  PAIR(2, 12) },
+    { 10, PAIR(1, 12) },
+    { 11, PAIR(0, 12) },
+
+    { 16, PAIR(0, 10) },
+    { 17, PAIR(1, 10) },
+    { 18, PAIR(2, 10) },
+    { 19, PAIR(3, 10) },
+    { 20, PAIR(4, 10) },
+    { 21, PAIR(4, 13) },
+    { 22, PAIR(3, 13) },
+    { 23, PAIR(2, 13) },
+    { 24, PAIR(1, 13) },
+    { 25, PAIR(0, 13) },
+
+    { 30, PAIR(0, 9) },
+    { 31, PAIR(1, 9) },
+    { 32, PAIR(2, 9) },
+    { 33, PAIR(3, 9) },
+    { 34, PAIR(4, 9) },
+    { 35, PAIR(4, 14) },
+    { 36, PAIR(3, 14) },
+    { 37, PAIR(2, 14) },
+    { 38, PAIR(1, 14) },
+    { 28, PAIR(0, 14) },
+
+    { 42, PAIR(0, 8) },
+    { 44, PAIR(1, 8) },
+    { 45, PAIR(2, 8) },
+    { 46, PAIR(3, 8) },
+    { 47, PAIR(4, 8) },
+    { 48, PAIR(4, 15) },
+    { 49, PAIR(3, 15) },
+    { 50, PAIR(2, 15) },
+    { 54, PAIR(1, 15) },
+    { 57, PAIR(0, 15) },
+
+    {331, PAIR(4, 11) },
+    {336, PAIR(4, 12) },
+    {328, PAIR(3, 12) },
+    {333, PAIR(2, 12) },
+    { 29, PAIR(0, 12) },
+};
+
+MainWindow::MainWindow(QWidget *parent)
+    : QMainWindow(parent)
+    , ui(new Ui::MainWindow)
+{
+
+    ui->setupUi(this);
+
+    ui->cbShowControls->setChecked(false);
+    ui->twControls->setVisible(false);
+
+    renderer = new ScreenRenderer(&frames, this);
+    ui->screen->setRenderer(renderer);
+    renderer->start();
+    // Кадр уходит в поток отрисовки, эмуляция его не ждёт
+    emulation = new EmulationThread(&frames, [this] { renderer->wake(); }, this);
+    // Частота устройства известна до первого кадра
+    audio = new AudioOutput(&emulation->audio(), this);
+    if (int rate = audio->start())
+        emulation->post(Command::SET_SAMPLE_RATE, rate);
+    emulation->start(QThread::TimeCriticalPriority);
+
+    connect(ui->keyboard,
+            SIGNAL(key_pressed(int,int)),
+            this,
+            SLOT(on_key_pressed(int,int)));
+    connect(ui->keyboard,
+            SIGNAL(key_released(int,int)),
+            this,
+            SLOT(on_key_released(int,int)));
+    connect(ui->btn_Reset,
+            SIGNAL(clicked()),
+            this,
+            SLOT(reset()));
+
+    connect(ui->pbUp,  SIGNAL(pressed()), this, SLOT(upPressed()));
+    connect(ui->pbDown, SIGNAL(pressed()), this, SLOT(downPressed()));
+    connect(ui->pbLeft, SIGNAL(pressed()), this, SLOT(leftPressed()));
+    connect(ui->pbRight, SIGNAL(pressed()), this, SLOT(rightPressed()));
+    connect(ui->pbFire,  SIGNAL(pressed()), this, SLOT(firePressed()));
+
+    connect(ui->pbUp,  SIGNAL(released()), this, SLOT(upRelease()));
+    connect(ui->pbDown, SIGNAL(released()), this, SLOT(downRelease()));
+    connect(ui->pbLeft, SIGNAL(released()), this, SLOT(leftRelease()));
+    connect(ui->pbRight, SIGNAL(released()), this, SLOT(rightRelease()));
+    connect(ui->pbFire, SIGNAL(released()), this, SLOT(fireRelease()));
+
+
+    error_timer = new QTimer();
+
+    connect(    error_timer,
+                SIGNAL(timeout()),
+                this,
+                SLOT(showErrors()));
+    error_timer->start(100);
+}
+
+MainWindow::~MainWindow()
+{
+    delete error_timer;
+    audio->stop();
+    emulation->stop();
+    qInfo().noquote() << "Frame pacing:" << emulation->pacer().summary();
+    const InputQueue &input = emulation->input_queue();
+    qInfo() << "Input:" << input.events() << "events, latency mean"
+            << input.mean_latency_us() << "us, max" << input.max_latency_us()
+            << "us," << input.dropped() << "dropped";
+    AudioStream &sound = emulation->audio();
+    qInfo() << "Audio: fill" << sound.fill() << "of target" << sound.target()
+            << "samples, rate adjust" << sound.adjust() << ","
+            << sound.underruns() << "underruns," << sound.dropped() << "dropped";
+    renderer->stop();
+    delete ui;
+}
+// Загрузка идёт в потоке эмуляции; ошибку покажет showErrors()
+bool MainWindow::load_sna(const QString &filename)
+{
+    return emulation->post(Command::LOAD_SNA, filename);
+}
+
+bool MainWindow::load_z80(const QString &filename)
+{
+    return emulation->post(Command::LOAD_Z80, filename);
+}
+
+// Ошибки команд ядро только описывает, показывает их GUI
+void MainWindow::showErrors()
+{
+    QString error;
+    while (emulation->take_error(error))
+        QMessageBox::warning(this, windowTitle(), error);
+}
+
+void MainWindow::upPressed()
+{
+    switch (ui->cbJoystickInterface->currentIndex()) {
+    case CURSOR_IF: emulation->input(InputEvent::KEY_PRESS, 3, 12);break;
+    case KEMPSTON_IF: emulation->input(InputEvent::KJ_PRESS, Port1F::KJ_UP);break;
+    case SINCLAIR_IF2: emulation->input(InputEvent::KEY_PRESS, 1, 12);break;
+        case SINCLAIR_IF2_2: emulation->input(InputEvent::KEY_PRESS, 3, 11);break;
+    }
+}
+
+void MainWindow::downPressed()
+{
+    switch (ui->cbJoystickInterface->currentIndex()) {
+    case CURSOR_IF: emulation->input(InputEvent::KEY_PRESS, 4, 12);break;
+    case KEMPSTON_IF: emulation->input(InputEvent::KJ_PRESS, Port1F::KJ_DOWN);break;
+    case SINCLAIR_IF2: emulation->input(InputEvent::KEY_PRESS, 2, 12);break;
+        case SINCLAIR_IF2_2: emulation->input(InputEvent::KEY_PRESS, 2, 11);break;
+    }
+}
+
+void MainWindow::leftPressed()
+{
+    switch (ui->cbJoystickInterface->currentIndex()) {
+    case CURSOR_IF: emulation->input(InputEvent::KEY_PRESS, 4, 11);break;
+    case KEMPSTON_IF: emulation->input(InputEvent::KJ_PRESS, Port1F::KJ_LEFT);break;
+        case SINCLAIR_IF2: emulation->input(InputEvent::KEY_PRESS, 4, 12);break;
+        case SINCLAIR_IF2_2: emulation->input(InputEvent::KEY_PRESS, 0, 11);break;
+    }
+}
+
+void MainWindow::rightPressed()
+{
+    switch (ui->cbJoystickInterface->currentIndex()) {
+    case CURSOR_IF: emulation->input(InputEvent::KEY_PRESS, 2, 12);break;
+    case KEMPSTON_IF: emulation->input(InputEvent::KJ_PRESS, Port1F::KJ_RIGHT);break;
+        case SINCLAIR_IF2: emulation->input(InputEvent::KEY_PRESS, 3, 12);break;
+        case SINCLAIR_IF2_2: emulation->input(InputEvent::KEY_PRESS, 1, 11);break;
+    }
+}
+
+void MainWindow::firePressed()
+{
+    switch (ui->cbJoystickInterface->currentIndex()) {
+    case CURSOR_IF: emulation->input(InputEvent::KEY_PRESS, 0, 12);break;
+    case KEMPSTON_IF: emulation->input(InputEvent::KJ_PRESS, Port1F::KJ_FIRE);break;
+        case SINCLAIR_IF2: emulation->input(InputEvent::KEY_PRESS, 0, 12);break;
+        case SINCLAIR_IF2_2: emulation->input(InputEvent::KEY_PRESS, 4, 11);break;
+    }
+}
+
+void MainWindow::keyPressed(int sc)
+{
+    auto elem =s_key_mapping.find(sc);
+    if (elem != s_key_mapping.end())
+    {
+        int row =FIRST(elem.value());
+        int col = SECOND(elem.value());
+        emulation->input(InputEvent::KEY_PRESS, row, col);
+    }
+}
+
+void MainWindow::upRelease()
+{
+    switch (ui->cbJoystickInterface->currentIndex()) {
+    case CURSOR_IF: emulation->input(InputEvent::KEY_RELEASE, 3, 12);break;
+    case KEMPSTON_IF: emulation->input(InputEvent::KJ_RELEASE, Port1F::KJ_UP);break;
+        case SINCLAIR_IF2: emulation->input(InputEvent::KEY_RELEASE, 1, 12);break;
+        case SINCLAIR_IF2_2: emulation->input(InputEvent::KEY_RELEASE, 3, 11);break;
+    }
+}
+
+void MainWindow::downRelease()
+{
+    switch (ui->cbJoystickInterface->currentIndex()) {
+    case CURSOR_IF: emulation->input(InputEvent::KEY_RELEASE, 4, 12);break;
+    case KEMPSTON_IF: emulation->input(InputEvent::KJ_RELEASE, Port1F::KJ_DOWN);break;
+        case SINCLAIR_IF2: emulation->input(InputEvent::KEY_RELEASE, 2, 12);break;
+        case SINCLAIR_IF2_2: emulation->input(InputEvent::KEY_RELEASE, 2, 11);break;
+    }
+}
+
+void MainWindow::leftRelease()
+{
+    switch (ui->cbJoystickInterface->currentIndex()) {
+    case CURSOR_IF: emulation->input(InputEvent::KEY_RELEASE, 4, 11);break;
+    case KEMPSTON_IF: emulation->input(InputEvent::KJ_RELEASE, Port1F::KJ_LEFT);break;
+        case SINCLAIR_IF2: emulation->input(InputEvent::KEY_RELEASE, 4, 12);break;
+        case SINCLAIR_IF2_2: emulation->input(InputEvent::KEY_RELEASE, 0, 11);break;
+    }
+}
+
+void MainWindow::fireRelease()
+{
+    switch (ui->cbJoystickInterface->currentIndex()) {
+    case CURSOR_IF: emulation->input(InputEvent::KEY_RELEASE, 0, 12);break;
+    case KEMPSTON_IF: emulation->input(InputEvent::KJ_RELEASE, Port1F::KJ_FIRE);break;
+        case SINCLAIR_IF2: emulation->input(InputEvent::KEY_RELEASE, 0, 12);break;
+        case SINCLAIR_IF2_2: emulation->input(InputEvent::KEY_RELEASE, 4, 11);break;
+    }
+}
+
+void MainWindow::rightRelease()
+{
+    switch (ui->cbJoystickInterface->currentIndex()) {
+    case CURSOR_IF: emulation->input(InputEvent::KEY_RELEASE, 2, 12);break;
+    case KEMPSTON_IF: emulation->input(InputEvent::KJ_RELEASE, Port1F::KJ_RIGHT);break;
+        case SINCLAIR_IF2: emulation->input(InputEvent::KEY_RELEASE, 3, 12);break;
+        case SINCLAIR_IF2_2: emulation->input(InputEvent::KEY_RELEASE, 1, 11);break;
+    }
+}
+
+void MainWindow::keyRelease(int sc)
+{
+    auto elem =s_key_mapping.find(sc);
+    if (elem != s_key_mapping.end())
+    {
+        int row =FIRST(elem.value());
+        int col = SECOND(elem.value());
+        emulation->input(InputEvent::KEY_RELEASE, row, col);
+    }
+}
+
+bool MainWindow::eventFilter(QObject *object, QEvent *event)
+{
+    Q_UNUSED(object);
+
+/*    if (event->type() ==QEvent::FocusOut and
+            object == ui->screen and
+            ui->cbCaptureKeyboard->isChecked()) {
+            ui->screen->setFocus();
+    }*/
+
+
+    if (event->type() == QEvent::KeyPress)
+    {
+        QKeyEvent *ke = static_cast<QKeyEvent*>(event);
+        qDebug() << "Key pressed: " << ke->nativeScanCode() << ke->text();
+        auto sc = ke->nativeScanCode();
+        switch (sc) {
+            case ESC_SCANCODE: reset();break;
+            case F12_SCANCODE: emulation->post(Command::NMI);break;
+            case UP_SCANCODE: upPressed();break;
+            case DOWN_SCANCODE: downPressed();break;
+            case LEFT_SCANCODE: leftPressed();break;
+            case RIGHT_SCANCODE: rightPressed();break;
+            case UP2_SCANCODE: upPressed();break;
+            case DOWN2_SCANCODE: downPressed();break;
+            case LEFT2_SCANCODE: leftPressed();break;
+            case RIGHT2_SCANCODE: rightPressed();break;
+            case LCTRL_SCANCODE: firePressed();break;
+            case RCTRL_SCANCODE: firePressed();break;
+            default :
+            {
+                keyPressed(sc);
+            }
+
+        }
+    }
+    if (event->type() == QEvent::KeyRelease)
+    {
+        QKeyEvent *ke = static_cast<QKeyEvent*>(event);
+        qDebug() << "Key release: " << ke->nativeScanCode() << ke->text();
+        auto sc = ke->nativeScanCode();
+
+        switch (sc) {
+
+            case UP_SCANCODE:       upRelease();break;
+            case DOWN_SCANCODE:   downRelease();break;
+            case LEFT_SCANCODE:   leftRelease();break;
+            case RIGHT_SCANCODE: rightRelease();break;
+            case UP2_SCANCODE:      upRelease();break;
+            case DOWN2_SCANCODE:  downRelease();break;
+            case LEFT2_SCANCODE:  leftRelease();break;
+            case RIGHT2_SCANCODE:rightRelease();break;
+            case LCTRL_SCANCODE:  fireRelease();break;
+            case RCTRL_SCANCODE:  fireRelease();break;
+            default :
+            {
+            keyRelease(sc);
+            }
+
+        }
+    }
+
+    return false;
+}
+
+void MainWindow::on_cbShowControls_stateChanged(int state)
+{
+    if (state == Qt::Checked)
+        ui->twControls->setVisible(true);
+    else
+        ui->twControls->setVisible(false);
+}
+
+void MainWindow::reset()
+{
+    emulation->post(Command::RESET);
+}
+
+void MainWindow::set_model(Machine::Model model)
+{
+    emulation->post(Command::SET_MODEL, model);
+}
+
+void MainWindow::on_key_pressed(int row, int col)
+{
+    qDebug() << "Key pressed: " << row << " " << col;
+    emulation->input(InputEvent::KEY_PRESS, row, col);
+
+}
+
+void MainWindow::on_key_released(int row, int col)
+{
+    qDebug() << "Key released: " << row << " " << col;
+    emulation->input(InputEvent::KEY_RELEASE, row, col);
+}
+
+void MainWindow::on_cbCaptureKeyboard_stateChanged(int state)
+{
+    if (state == Qt::Checked)
+    {
+        installEventFilter(this);
+    }
+    else
+    {
+        installEventFilter(nullptr);
+    }
+
+}
+
+void MainWindow::on_buttonTEST_clicked()
+{
+    load_sna("sna/river.sna");
+}
+
+void MainWindow::on_actionSpectrum_48k_triggered()
+{
+    ui->actionSpectrum_48k->setChecked(true);
+    ui->actionSpectrum_128k->setChecked(false);
+    set_model(Machine::MODEL_48K);
+}
+
+void MainWindow::on_actionSpectrum_128k_triggered()
+{
+    ui->actionSpectrum_48k->setChecked(false);
+    ui->actionSpectrum_128k->setChecked(true);
+    set_model(Machine::MODEL_128K);
+}
+
+void MainWindow::on_action_Load_a_snapshot_triggered()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open File"),"sna/","*.sna");
+    if (not fileName.isEmpty())
+        load_sna(fileName);
+}
+
+void MainWindow::on_action_Exit_triggered()
+{
+    exit(0);
+}
+
+void MainWindow::on_action_Reset_triggered()
+{
+    reset();
+}
+
+void MainWindow::on_action_NMI_triggered()
+{
+    emulation->post(Command::NMI);
+}
+
+void MainWindow::on_action_About_triggered()
+{
+    QMessageBox aboutBox;
+    aboutBox.setWindowTitle("About");
+    aboutBox.setText("Emulator ZX spectrum\nby Basserti\n2021");
+    aboutBox.exec();
+}
+
+void MainWindow::on_action_color1_triggered()
+{
+    ui->action_color1->setChecked(true);
+    ui->action_color2->setChecked(false);
+    emulation->post(Command::SET_PALETTE, 1);
+}
+
+void MainWindow::on_action_color2_triggered()
+{
+    ui->action_color1->setChecked(false);
+    ui->action_color2->setChecked(true);
+    emulation->post(Command::SET_PALETTE, 2);
+}
+
+void MainWindow::on_actionLoad_a_SCR_file_triggered()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open File"),"scr/","*.scr");
+    if (not fileName.isEmpty())
+        emulation->post(Command::LOAD_SCR, fileName);
+}
+
+void MainWindow::on_actionSave_a_SCR_file_triggered()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save File"),"scr/","*.scr");
+    if (not fileName.isEmpty())
+        emulation->post(Command::SAVE_SCR, fileName);
+}
+
+void MainWindow::on_actionLoad_a_z80_file_triggered()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open File"),"sna/","*.z80");
+    if (not fileName.isEmpty())
+        load_z80(fileName);
+}
+
+void MainWindow::on_actionSave_a_z80_file_triggered()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save File"),"sna/","*.z80");
+    if (not fileName.isEmpty())
+        emulation->post(Command::SAVE_Z80, fileName);
+}
+
+void MainWindow::on_actionOpen_a_tape_triggered()
+{
+    QString fileName = QFileDialog::getOpenFileName(this, tr("Open File"),"tap/","*.tap *.tzx");
+    if (not fileName.isEmpty())
+        emulation->post(Command::TAPE_OPEN, fileName);
+}
+
+void MainWindow::on_actionPlay_tape_triggered()
+{
+    emulation->post(Command::TAPE_PLAY);
+}
+
+void MainWindow::on_actionStop_tape_triggered()
+{
+    emulation->post(Command::TAPE_STOP);
+}
+
+void MainWindow::on_actionRewind_tape_triggered()
+{
+    emulation->post(Command::TAPE_REWIND);
+}
+
+void MainWindow::on_actionRecord_tape_triggered()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save File"),"tap/","*.tap *.tzx *.csw");
+    if (not fileName.isEmpty())
+        emulation->post(Command::TAPE_RECORD, fileName);
+}
+
+void MainWindow::on_actionStop_recording_triggered()
+{
+    emulation->post(Command::TAPE_RECORD_STOP);
+}
+
+void MainWindow::on_actionInstant_load_triggered(bool checked)
+{
+    emulation->post(Command::TAPE_TRAPS, checked);
+}
+
+void MainWindow::on_actionTurbo_load_triggered(bool checked)
+{
+    emulation->post(Command::TAPE_TURBO, checked);
+}
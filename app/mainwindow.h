@@ -2,10 +2,13 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include "businterface.h"
-#include "emulation/CPU/Z80.h"
+#include "emulationthread.h"
+#include "framequeue.h"
 #include <QTimer>
 
+class ScreenRenderer;
+class AudioOutput;
+
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
 QT_END_NAMESPACE
@@ -18,8 +21,8 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
-    void load_sna(const QString& filename);
-    void load_z80(const QString& filename);
+    bool load_sna(const QString& filename);
+    bool load_z80(const QString& filename);
 
     void keyPressed(int sc);
 
@@ -50,7 +53,7 @@ protected:
     virtual bool eventFilter(QObject *object, QEvent *event) override;
 
 private slots:
-    void frameRefresh();
+    void showErrors();
 
     void on_cbShowControls_stateChanged(int state);
 
@@ -89,14 +92,34 @@ private slots:
 
     void on_actionSave_a_z80_file_triggered();
 
+    void on_actionOpen_a_tape_triggered();
+
+    void on_actionPlay_tape_triggered();
+
+    void on_actionStop_tape_triggered();
+
+    void on_actionRewind_tape_triggered();
+
+    void on_actionRecord_tape_triggered();
+
+    void on_actionStop_recording_triggered();
+
+    void on_actionInstant_load_triggered(bool checked);
+
+    void on_actionTurbo_load_triggered(bool checked);
+
 private:
     Ui::MainWindow *ui;
 
-    BusInterface * bus { nullptr };
+    using Command = EmulationThread::Command;
+
+    void set_model(Machine::Model model);
+
+    QTimer *error_timer;
 
-    // redcode/Z80
-    Z80 cpustate {};
-    QTimer *frame_timer;
-    QTimer *flash_timer;
+    FrameQueue frames;                      // эмуляция -> renderer
+    ScreenRenderer *renderer { nullptr };
+    EmulationThread *emulation { nullptr };
+    AudioOutput *audio { nullptr };
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,194 @@
+#include "screenrenderer.h"
+#include <QPainter>
+#include <QMutexLocker>
+#include <algorithm>
+
+// color - GRB (no RGB!)
+static const QRgb s_palette_1[16]{
+    qRgb(  0,   0,   0),
+    qRgb(  0,   0, 192),
+    qRgb(192,   0,   0),
+    qRgb(192,   0, 192),
+    qRgb(  0, 192,   0),
+    qRgb(  0, 192, 192),
+    qRgb(192, 192,   0),
+    qRgb(192, 192, 192),
+
+    qRgb(  0,   0,   0),
+    qRgb( 96,  96, 255),
+    qRgb(255,  96,  96),
+    qRgb(255,  96, 255),
+    qRgb( 96, 255,  96),
+    qRgb( 96, 255, 255),
+    qRgb(255, 255,  96),
+    qRgb(255, 255, 255),
+};
+
+static const QRgb s_palette_2[16]{
+    qRgb(  0,   0,   0),
+    qRgb(  0,   0, 192),
+    qRgb(192,   0,   0),
+    qRgb(192,   0, 192),
+    qRgb(  0, 192,   0),
+    qRgb(  0, 192, 192),
+    qRgb(192, 192,   0),
+    qRgb(192, 192, 192),
+
+    qRgb(  0,   0,   0),
+    qRgb(  0,   0, 255),
+    qRgb(255,   0,   0),
+    qRgb(255,   0, 255),
+    qRgb(  0, 255,   0),
+    qRgb(  0, 255, 255),
+    qRgb(255, 255,   0),
+    qRgb(255, 255, 255),
+};
+
+ScreenRenderer::ScreenRenderer(FrameQueue *frames, QObject *parent)
+    : QThread(parent)
+    , _frames(frames)
+{
+}
+
+ScreenRenderer::~ScreenRenderer()
+{
+    stop();
+}
+
+void ScreenRenderer::wake()
+{
+    // Поток разбудится один раз, сколько бы кадров ни пришло
+    if (_wake.available() == 0)
+        _wake.release();
+}
+
+void ScreenRenderer::stop()
+{
+    if (not isRunning())
+        return;
+    _stop = true;
+    _wake.release();
+    wait();
+}
+
+void ScreenRenderer::run()
+{
+    for (;;) {
+        _wake.acquire();
+        if (_stop)
+            break;
+        if (const Frame *frame = _frames->consume())
+            render(*frame);
+    }
+}
+
+void ScreenRenderer::render(const Frame &frame)
+{
+    // Палитра меняется редко: таблицы атрибутов пересчитываются только тогда
+    const QRgb *palette = frame.palette == 1 ? s_palette_1 : s_palette_2;
+    if (palette != _palette) {
+        _palette = palette;
+        _decoder.set_palette(palette);
+    }
+
+    // Изменения кадра нужны обоим изображениям: заднему сейчас, показываемому -
+    // когда он станет задним. Пропущенные кадры - изменения неизвестны
+    bool skipped = frame.number != _last_number + 1;
+    _last_number = frame.number;
+    for (Target &target : _targets)
+        for (int row = 0; row < ScreenDecoder::ATTR_HEIGHT; row++)
+            target.pending[row] |= skipped ? ~0u : frame.dirty[row];
+
+    Target &back = _targets[_back];
+    const Target &front = _targets[1 - _back];
+    int n = _scale;
+    if (back.image.width() != ScreenDecoder::WIDTH * n or back.palette != palette) {
+        if (back.image.width() != ScreenDecoder::WIDTH * n)
+            back.image = QImage(ScreenDecoder::WIDTH * n, ScreenDecoder::HEIGHT * n,
+                                QImage::Format_RGB32);
+        back.palette = palette;
+        std::fill(std::begin(back.pending), std::end(back.pending), ~0u);
+    }
+    // Сменилась фаза мигания - перерисовать все мигающие знакоместа
+    if (back.flash != frame.flash) {
+        back.flash = frame.flash;
+        ScreenDecoder::mark_flash(frame.vram, back.pending);
+    }
+
+    // Экран разворачивается сразу в нужном масштабе (SIMD-ядро
+    // ScreenDecoder), только изменившиеся знакоместа
+    _decoder.decode_dirty(frame.vram, frame.flash,
+                          reinterpret_cast<uint32_t *>(back.image.bits()),
+                          back.image.bytesPerLine() / 4, n, back.pending);
+
+    // Строка знакомест - один прямоугольник от первого до последнего грязного
+    QRegion region;
+    int cell = 8 * n;
+    for (int cy = 0; cy < ScreenDecoder::ATTR_HEIGHT; cy++) {
+        uint32_t dirty = back.pending[cy];
+        back.pending[cy] = 0;
+        if (not dirty)
+            continue;
+        int first = 0, last = ScreenDecoder::ATTR_WIDTH - 1;
+        while (not (dirty & (1u << first)))
+            first++;
+        while (not (dirty & (1u << last)))
+            last--;
+        region += QRect(first * cell, cy * cell, (last - first + 1) * cell, cell);
+    }
+
+    std::copy(std::begin(frame.border), std::end(frame.border), std::begin(back.border));
+    back.lines = frame.lines;
+    back.screen_line = frame.screen_line;
+    bool border = back.image.size() != front.image.size() or back.palette != front.palette
+            or back.lines != front.lines or back.screen_line != front.screen_line
+            or not std::equal(back.border, back.border + back.lines, front.border);
+
+    {
+        QMutexLocker lock(&_mutex);
+        _back = 1 - _back;
+    }
+    emit rendered(region, border);
+}
+
+// Экран по центру виджета
+static QRect centered(const QRect &widget, const QSize &size)
+{
+    return QRect(widget.left() + (widget.width() - size.width()) / 2,
+                 widget.top() + (widget.height() - size.height()) / 2,
+                 size.width(), size.height());
+}
+
+QRect ScreenRenderer::screen_rect(const QRect &widget)
+{
+    QMutexLocker lock(&_mutex);
+    return centered(widget, _targets[1 - _back].image.size());
+}
+
+void ScreenRenderer::draw(QPainter &p, const QRect &widget)
+{
+    QMutexLocker lock(&_mutex);
+    const Target &front = _targets[1 - _back];
+    if (front.image.isNull())
+        return;
+    QRect screen = centered(widget, front.image.size());
+
+    // Бордюр - полосами одного цвета; строка развёртки line начинается
+    // на (line - screen_line) * n от верха экрана, крайние строки
+    // тянутся до краёв виджета
+    int n = front.image.width() / ScreenDecoder::WIDTH;
+    for (int line = 0; line < front.lines;) {
+        int end = line + 1;
+        while (end < front.lines and front.border[end] == front.border[line])
+            end++;
+        int y0 = line == 0 ? widget.top()
+                           : screen.top() + (line - front.screen_line) * n;
+        int y1 = end == front.lines ? widget.bottom() + 1
+                                    : screen.top() + (end - front.screen_line) * n;
+        if (y1 > y0)
+            p.fillRect(widget.left(), y0, widget.width(), y1 - y0,
+                       QColor(front.palette[front.border[line]]));
+        line = end;
+    }
+    p.drawImage(screen.topLeft(), front.image);
+}
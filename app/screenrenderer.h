@@ -0,0 +1,75 @@
+#ifndef SCREENRENDERER_H
+#define SCREENRENDERER_H
+
+#include <QThread>
+#include <QImage>
+#include <QMutex>
+#include <QSemaphore>
+#include <QRegion>
+#include <atomic>
+#include "framequeue.h"
+#include "screendecoder.h"
+
+class QPainter;
+
+// Поток отрисовки: забирает из FrameQueue самый свежий кадр и
+// разворачивает его изменившиеся знакоместа в одно из двух изображений.
+// Готовое изображение меняется местами с показываемым под мьютексом,
+// потоку GUI остаётся только вывести его в draw(). Эмуляция от отрисовки
+// не ждёт ничего: медленный вывод лишь пропускает кадры.
+class ScreenRenderer : public QThread
+{
+    Q_OBJECT
+public:
+    explicit ScreenRenderer(FrameQueue *frames, QObject *parent = nullptr);
+    ~ScreenRenderer() override;
+
+    // В очереди новый кадр. Не блокирует
+    void wake();
+    void stop();
+
+    // Масштаб следующих кадров (виджет поменял размер)
+    void set_scale(int scale) { _scale = scale; }
+
+    // Развернуть кадр: в своём потоке, бенчмарк зовёт напрямую
+    void render(const Frame &frame);
+
+    // Из потока GUI: показываемый кадр с бордюром в область widget,
+    // экран по центру
+    void draw(QPainter &p, const QRect &widget);
+    // Где будет экран показываемого кадра внутри widget
+    QRect screen_rect(const QRect &widget);
+
+signals:
+    // Показываемый кадр сменился; region - изменившиеся области экрана
+    // в его координатах, border - изменился бордюр
+    void rendered(const QRegion &region, bool border);
+
+protected:
+    void run() override;
+
+private:
+    struct Target
+    {
+        QImage image;
+        BusInterface::DirtyMap pending {};  // изменения, которых в image ещё нет
+        bool flash { false };
+        uint8_t border[Frame::MAX_LINES] {};
+        int lines { 0 };
+        int screen_line { 0 };
+        const QRgb *palette { nullptr };
+    };
+
+    FrameQueue *_frames;
+    ScreenDecoder _decoder;
+    const QRgb *_palette { nullptr };       // палитра, под которую посчитан _decoder
+    uint64_t _last_number { 0 };
+    Target _targets[2];
+    int _back { 0 };                        // куда рисуется, 1 - _back показывается
+    std::atomic<int> _scale { 1 };
+    std::atomic<bool> _stop { false };
+    QSemaphore _wake;
+    QMutex _mutex;                          // смена _back и чтение показываемого
+};
+
+#endif // SCREENRENDERER_H
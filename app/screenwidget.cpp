@@ -0,0 +1,54 @@
+#include "screenwidget.h"
+#include "screenrenderer.h"
+#include <QPainter>
+#include <algorithm>
+
+ScreenWidget::ScreenWidget(QWidget *parent) : QWidget(parent)
+{
+    setFocusPolicy(Qt::FocusPolicy::StrongFocus);
+}
+
+void ScreenWidget::setRenderer(ScreenRenderer *renderer)
+{
+    _renderer = renderer;
+    _renderer->set_scale(scaleFor(size()));
+    connect(_renderer, &ScreenRenderer::rendered, this, &ScreenWidget::frameRendered);
+}
+
+//каждый пиксель - квадрат со стороной n
+// n - цело положительное число, n > 0
+// n - наибольшее, при котором изображение помещается на экран
+//  (и по вертикали, и по горизонтали)
+int ScreenWidget::scaleFor(const QSize &size)
+{
+    // nw = "n" по горизонтали
+    // nh = "n" вертикали
+    int nw = (size.width() - 2 * BORDER_MIN_WIDTH) / SCREEN_WIDTH;
+    int nh = (size.height() - 2 * BORDER_MIN_HEIGHT) / SCREEN_HEIGHT;
+    return std::max(std::min(nw, nh), 1);
+}
+
+void ScreenWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    // Новый масштаб - со следующего кадра, до него старый кадр по центру
+    if (_renderer)
+        _renderer->set_scale(scaleFor(size()));
+}
+
+void ScreenWidget::frameRendered(const QRegion &region, bool border)
+{
+    if (border)
+        update();
+    else if (not region.isEmpty())
+        update(region.translated(_renderer->screen_rect(rect()).topLeft()));
+}
+
+void ScreenWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    if (not _renderer)
+        return;
+    QPainter p(this);
+    _renderer->draw(p, rect());
+}
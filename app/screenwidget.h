@@ -2,7 +2,9 @@
 #define SCREENWIDGET_H
 
 #include <QWidget>
-#include "businterface.h"
+#include <QRegion>
+
+class ScreenRenderer;
 
 class ScreenWidget : public QWidget
 {
@@ -17,20 +19,21 @@ public:
 
     explicit ScreenWidget(QWidget *parent = nullptr);
 
-    void setBusInterface(const BusInterface *bi);
-
-public slots:
-    void toggleFlash() { flash_state = !flash_state; }
+    // Кадры разворачивает renderer в своём потоке, виджет их только выводит
+    void setRenderer(ScreenRenderer *renderer);
 
-signals:
+    // Масштаб экрана для размера size
+    static int scaleFor(const QSize &size);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
 
+private slots:
+    void frameRendered(const QRegion &region, bool border);
 
 private:
-    const BusInterface * _bi { nullptr };
-    bool flash_state { false };
+    ScreenRenderer * _renderer { nullptr };
 };
 
 #endif // SCREENWIDGET_H
@@ -0,0 +1,572 @@
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QPainter>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "ay8912.h"
+#include "beeper.h"
+#include "businterface48.h"
+#include "businterface128.h"
+#include "machine.h"
+#include "portfe.h"
+#include "screendecoder.h"
+#include "framequeue.h"
+#include "screenrenderer.h"
+
+// Минимальное время одного замера; число повторов подбирается удвоением
+static constexpr double MIN_SECONDS = 0.2;
+static constexpr int SNAPSHOT_FRAMES = 500;
+
+static volatile uint32_t s_sink; // не даёт компилятору выкинуть циклы
+
+static QJsonArray s_results;
+
+static void report(const char *group, const QString &name, const char *unit, double value)
+{
+    QJsonObject result;
+    result["group"] = group;
+    result["name"] = name;
+    result["unit"] = unit;
+    result["value"] = value;
+    s_results.append(result);
+    std::fprintf(stderr, "%-10s %-28s %12.2f %s\n", group, qPrintable(name), value, unit);
+}
+
+// run(n) делает n операций; возвращает операций в секунду
+template <class Run>
+static double ops_per_second(Run run)
+{
+    for (uint64_t n = 1024;; n *= 2) {
+        auto start = std::chrono::steady_clock::now();
+        run(n);
+        double seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+        if (seconds >= MIN_SECONDS)
+            return n / seconds;
+    }
+}
+
+// --- Смеси инструкций ----------------------------------------------------
+
+static uint8_t s_mem_read(void *context, uint16_t address)
+{
+    return reinterpret_cast<BusInterface*>(context)->page_read8(address);
+}
+
+static void s_mem_write(void *context, uint16_t address, uint8_t value)
+{
+    reinterpret_cast<BusInterface*>(context)->page_write8(address, value);
+}
+
+static uint8_t s_port_read(void *context, uint16_t address)
+{
+    return reinterpret_cast<BusInterface*>(context)->io_read8(address);
+}
+
+static void s_port_write(void *context, uint16_t address, uint8_t value)
+{
+    reinterpret_cast<BusInterface*>(context)->io_write8(address, value);
+}
+
+static uint32_t s_int_data(void *context)
+{
+    Q_UNUSED(context);
+    return 0xC3000000; // JP #0
+}
+
+struct Mix
+{
+    const char *name;
+    std::vector<uint8_t> body;  // тело цикла, без перехода назад
+};
+
+// Как в zexdoc: каждая смесь крутит одну группу инструкций в цикле
+// с DI, регистры-указатели перезагружаются на каждом проходе, поэтому
+// записи не уходят за C000-E1FF.
+static const Mix s_mixes[] = {
+    { "ld/alu", {
+          0x78, 0x81, 0x92, 0xA3, 0xB4, 0xAD, 0x04, 0x0D,   // ld a,b .. dec c
+          0xBE, 0x8F, 0x9A, 0x27, 0x2F, 0x3F, 0x07, 0x1F    // cp (hl) .. rra
+      } },
+    { "memory", {
+          0x21, 0x00, 0xC0, 0x11, 0x00, 0xD0,               // ld hl/de
+          0x7E, 0x12, 0x23, 0x13, 0x7E, 0x12,               // ld a,(hl) ..
+          0xDD, 0x77, 0x01, 0xFD, 0x46, 0x02,               // ld (ix+1),a; ld b,(iy+2)
+          0x32, 0x00, 0xE1, 0x3A, 0x01, 0xE1,               // ld (#E100),a; ld a,(#E101)
+          0x34, 0x35                                        // inc (hl); dec (hl)
+      } },
+    { "stack/call", {
+          0xC5, 0xD1, 0xE5, 0xE1,                           // push bc; pop de ..
+          0xCD, 0x00, 0x00                                  // call sub (адрес ниже)
+      } },
+    { "cb/bit", {
+          0xCB, 0x00, 0xCB, 0x5F, 0xCB, 0xCE, 0xCB, 0x91,   // rlc b .. res 2,c
+          0xCB, 0x3A, 0xCB, 0x11,                           // srl d; rl c
+          0xDD, 0xCB, 0x03, 0x46, 0xFD, 0xCB, 0x04, 0xC6    // bit 0,(ix+3); set 0,(iy+4)
+      } },
+    { "ed/block", {
+          0x21, 0x00, 0xC0, 0x11, 0x00, 0xD0, 0x01, 0x20, 0x00,
+          0xED, 0xB0,                                       // ldir, 32 байта
+          0x21, 0x00, 0xC0, 0x01, 0x20, 0x00,
+          0xED, 0xB1,                                       // cpir
+          0xED, 0x44, 0xED, 0x6F, 0xED, 0x5A, 0xED, 0x52    // neg; rld; adc/sbc hl,de
+      } },
+    { "index", {
+          0xDD, 0x21, 0x00, 0xE0, 0xFD, 0x21, 0x00, 0xE0,   // ld ix/iy,#E000
+          0xDD, 0x09, 0xFD, 0x19,                           // add ix,bc; add iy,de
+          0xDD, 0x21, 0x00, 0xE0, 0xFD, 0x21, 0x00, 0xE0,
+          0xDD, 0x34, 0x03, 0xFD, 0x35, 0x04, 0xDD, 0x7E, 0x05
+      } },
+};
+
+// di; ld sp,#FF00; ld hl,#C000; ld ix,#E000; ld iy,#E000
+static const uint8_t s_prologue[] = {
+    0xF3, 0x31, 0x00, 0xFF, 0x21, 0x00, 0xC0,
+    0xDD, 0x21, 0x00, 0xE0, 0xFD, 0x21, 0x00, 0xE0
+};
+
+// Код с адреса #8000 на чистом CPU поверх bus
+static void load_code(const std::vector<uint8_t> &code, Z80 &cpu, BusInterface &bus)
+{
+    std::memset(&cpu, 0, sizeof(cpu));
+    cpu.context = &bus;
+    cpu.read = s_mem_read;
+    cpu.write = s_mem_write;
+    cpu.in = s_port_read;
+    cpu.out = s_port_write;
+    cpu.int_data = s_int_data;
+    z80_reset(&cpu);
+    for (size_t i = 0; i < code.size(); i++)
+        bus.mem_write8(uint32_t(0x8000 + i), code[i]);
+    cpu.state.pc = 0x8000;
+}
+
+static void load_mix(const Mix &mix, Z80 &cpu, BusInterface &bus)
+{
+    std::vector<uint8_t> code(s_prologue, s_prologue + sizeof(s_prologue));
+    uint16_t loop = uint16_t(0x8000 + code.size());
+    code.insert(code.end(), mix.body.begin(), mix.body.end());
+    code.insert(code.end(), { 0xC3, uint8_t(loop), uint8_t(loop >> 8) });   // jp loop
+    uint16_t sub = uint16_t(0x8000 + code.size());
+    code.push_back(0xC9);                                                   // sub: ret
+    if (std::strcmp(mix.name, "stack/call") == 0) {
+        size_t call = sizeof(s_prologue) + mix.body.size() - 2;
+        code[call] = uint8_t(sub);
+        code[call + 1] = uint8_t(sub >> 8);
+    }
+    load_code(code, cpu, bus);
+}
+
+static void bench_mixes()
+{
+    for (const Mix &mix : s_mixes) {
+        BusInterface48 bus_c, bus_t;
+        Z80 cpu_c, cpu_t;
+        load_mix(mix, cpu_c, bus_c);
+        load_mix(mix, cpu_t, bus_t);
+
+        // операция - 1000 тактов, результат в МГц
+        double c = ops_per_second([&](uint64_t n) { z80_run(&cpu_c, zusize(n * 1000)); });
+        double t = ops_per_second([&](uint64_t n) { bus_t.run_cpu(&cpu_t, zusize(n * 1000)); });
+        report("z80_run", QString(mix.name) + " (C API)", "MHz", c / 1e3);
+        report("z80_run", QString(mix.name) + " (Z80Core)", "MHz", t / 1e3);
+    }
+}
+
+// --- Шина ----------------------------------------------------------------
+
+static void bench_bus(const char *model, BusInterface &bus)
+{
+    QString prefix = QString(model) + " ";
+    report("bus", prefix + "mem_read8", "Mops/s", ops_per_second([&](uint64_t n) {
+        uint32_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+            sum += bus.mem_read8(uint32_t(i * 97) & 0xffff);
+        s_sink = sum;
+    }) / 1e6);
+    report("bus", prefix + "mem_write8", "Mops/s", ops_per_second([&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++)
+            bus.mem_write8(0x8000 | (uint32_t(i * 97) & 0x3fff), uint8_t(i));
+    }) / 1e6);
+    report("bus", prefix + "page_read8", "Mops/s", ops_per_second([&](uint64_t n) {
+        uint32_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+            sum += bus.page_read8(uint16_t(i * 97));
+        s_sink = sum;
+    }) / 1e6);
+    report("bus", prefix + "page_write8", "Mops/s", ops_per_second([&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++)
+            bus.page_write8(uint16_t(0x8000 | ((i * 97) & 0x3fff)), uint8_t(i));
+    }) / 1e6);
+    report("bus", prefix + "io_read8 #FE", "Mops/s", ops_per_second([&](uint64_t n) {
+        uint32_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+            sum += bus.io_read8(uint32_t((i & 0xff) << 8) | 0xfe);
+        s_sink = sum;
+    }) / 1e6);
+    report("bus", prefix + "io_write8 #FE", "Mops/s", ops_per_second([&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++)
+            bus.io_write8(0xfe, uint8_t(i & 7));
+    }) / 1e6);
+}
+
+static void bench_buses()
+{
+    BusInterface48 bus48;
+    BusInterface128 bus128;
+    bench_bus("48K", bus48);
+    bench_bus("128K", bus128);
+
+    // Переключение банка перестраивает таблицу страниц
+    report("bus", "128K io_write8 #7FFD", "Mops/s", ops_per_second([&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++)
+            bus128.io_write8(0x7ffd, uint8_t(i & 7));
+    }) / 1e6);
+    bus128.reset();
+}
+
+static void bench_portfe()
+{
+    PortFE port;
+    port.press_key(0, 8);
+    port.press_key(2, 12);
+    // Опрос одного полуряда, как в KEY-SCAN, и всех сразу (IN A,(#00FE))
+    report("portfe", "read8 one half-row", "Mops/s", ops_per_second([&](uint64_t n) {
+        uint32_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+            sum += port.read8(uint32_t(uint8_t(~(1 << (i & 7)))) << 8 | 0xfe);
+        s_sink = sum;
+    }) / 1e6);
+    report("portfe", "read8 all half-rows", "Mops/s", ops_per_second([&](uint64_t n) {
+        uint32_t sum = 0;
+        for (uint64_t i = 0; i < n; i++)
+            sum += port.read8(0x00fe);
+        s_sink = sum;
+    }) / 1e6);
+
+    // KEY-SCAN из ПЗУ 48К (#028E) в цикле, с нажатыми клавишами: восемь
+    // IN A,(C) на опрос и разбор результата. Счётчик опросов - в IX,
+    // KEY-SCAN его не трогает
+    BusInterface48 bus;
+    if (not bus.rom_device().loaded())
+        return;
+    bus.key_press(0, 8);
+    bus.key_press(3, 13);
+    Z80 cpu;
+    // di; ld sp,#FF00; ld ix,0; loop: call #028E; inc ix; jr loop
+    load_code({ 0xF3, 0x31, 0x00, 0xFF, 0xDD, 0x21, 0x00, 0x00,
+                0xCD, 0x8E, 0x02, 0xDD, 0x23, 0x18, 0xF9 }, cpu, bus);
+    report("portfe", "ROM KEY-SCAN", "kscans/s", ops_per_second([&](uint64_t n) {
+        uint16_t last = cpu.state.ix.value_uint16;
+        for (uint64_t done = 0; done < n;) {
+            z80_run(&cpu, 20000);
+            done += uint16_t(cpu.state.ix.value_uint16 - last);
+            last = cpu.state.ix.value_uint16;
+        }
+    }) / 1e3);
+}
+
+// --- Звук --------------------------------------------------------------
+
+// Кадр 48К в сэмплы 48 кГц: без фронтов (цена на сэмпл) и с тоном
+// ~5 кГц (200 фронтов, цена на фронт)
+static void bench_beeper()
+{
+    for (int edges : { 0, 200 }) {
+        Beeper beeper(48000, 3500000);
+        std::vector<int16_t> out;
+        const uint64_t frame = 69888;
+        uint64_t start = 0;
+        int level = 0;
+        report("beeper", QString("frame, %1 edges").arg(edges), "kframes/s", ops_per_second([&](uint64_t n) {
+            for (uint64_t f = 0; f < n; f++) {
+                for (int e = 0; e < edges; e++) {
+                    level ^= 2;
+                    beeper.edge(start + uint64_t(e) * (frame / 200), level);
+                }
+                start += frame;
+                out.clear();
+                beeper.end_frame(start, out);
+            }
+            s_sink = uint32_t(out.size());
+        }) / 1e3);
+    }
+}
+
+// AY 128К: три канала с тоном, шум и огибающая во всех сразу.
+// Результат - процессорное время на секунду эмуляции
+static void bench_ay()
+{
+    const MachineTiming &timing = TIMING_128K;
+    AY8912 ay;
+    ay.set_clock(timing.cpu_hz, timing.ay_hz, 48000, 0);
+    const uint8_t registers[14] = { 100, 0, 150, 0, 200, 0, 5, 0x30, 16, 12, 16, 0, 2, 0x0e };
+    for (int reg = 0; reg < 14; reg++) {
+        ay.write8(0xfffd, uint8_t(reg));
+        ay.write8(0xbffd, registers[reg]);
+    }
+    std::vector<int16_t> out(1024);
+    int count = int(48000 / timing.frame_rate());
+    uint64_t now = 0;
+    double frames = ops_per_second([&](uint64_t n) {
+        for (uint64_t f = 0; f < n; f++) {
+            now += timing.frame_cycles;
+            std::fill(out.begin(), out.begin() + count, int16_t(0));
+            ay.end_frame(now, out.data(), count);
+        }
+        s_sink = uint32_t(out[0]);
+    });
+    report("ay", "AY-3-8912 128K", "ms/s", 1e3 * timing.frame_rate() / frames);
+
+    // Сложение каналов отдельно: шагов за секунду
+    std::vector<int16_t> a(4432, 1), b(4432, 2), c(4432, 3), mixed(4432);
+    report("ay", "mix 3 channels", "Msteps/s", ops_per_second([&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++)
+            AY8912::mix(a.data(), b.data(), c.data(), mixed.data(), int(mixed.size()));
+        s_sink = uint32_t(mixed[0]);
+    }) * double(mixed.size()) / 1e6);
+}
+
+// --- Отрисовка -----------------------------------------------------------
+
+static void bench_render()
+{
+    Machine machine(Machine::MODEL_48K);
+    machine.load_sna("sna/river.sna");
+    for (int f = 0; f < 50; f++)
+        machine.run_frame();
+
+    // Развёртка экрана в буфер без QPainter: скалярный цикл против
+    // векторных ядер, доступных на этом процессоре
+    ScreenDecoder decoder;
+    static const uint32_t palette[16] {
+        0xff000000, 0xff0000c0, 0xffc00000, 0xffc000c0,
+        0xff00c000, 0xff00c0c0, 0xffc0c000, 0xffc0c0c0,
+        0xff000000, 0xff0000ff, 0xffff0000, 0xffff00ff,
+        0xff00ff00, 0xff00ffff, 0xffffff00, 0xffffffff
+    };
+    decoder.set_palette(palette);
+    for (int k = ScreenDecoder::KERNEL_SCALAR; k <= ScreenDecoder::KERNEL_NEON; k++) {
+        auto kernel = ScreenDecoder::Kernel(k);
+        if (not ScreenDecoder::kernel_supported(kernel))
+            continue;
+        decoder.set_kernel(kernel);
+        for (int scale : { 1, 2, 4 }) {
+            int stride = ScreenDecoder::WIDTH * scale;
+            std::vector<uint32_t> buffer(size_t(stride) * ScreenDecoder::HEIGHT * scale);
+            report("render", QString("decode %1 %2x").arg(ScreenDecoder::kernel_name(kernel)).arg(scale),
+                   "frames/s", ops_per_second([&](uint64_t n) {
+                for (uint64_t i = 0; i < n; i++)
+                    decoder.decode(machine.bus()->framebuffer(), i & 1, buffer.data(), stride, scale);
+                s_sink = buffer[n % buffer.size()];
+            }));
+        }
+    }
+
+    // Поток отрисовки приложения без самого потока: кадр из FrameQueue
+    // целиком (номер не подряд - всё заново) и вывод с бордюром в QImage
+    FrameQueue frames;
+    ScreenRenderer renderer(&frames);
+    Frame &frame = frames.production_frame();
+    machine.capture_frame(frame);
+    for (int scale : { 1, 2, 4 }) {
+        renderer.set_scale(scale);
+        QImage image(ScreenDecoder::WIDTH * scale + 64, ScreenDecoder::HEIGHT * scale + 64,
+                     QImage::Format_RGB32);
+        report("render", QString("ScreenRenderer %1x").arg(scale), "frames/s",
+               ops_per_second([&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) {
+                frame.number += 2;
+                renderer.render(frame);
+                QPainter p(&image);
+                renderer.draw(p, image.rect());
+            }
+        }));
+    }
+}
+
+// Цена кадра на почти неподвижном экране (меню 128К): кадр эмуляции,
+// снимок для вывода и развёртка только грязных знакомест против
+// развёртки всего экрана
+static void bench_static_screen()
+{
+    Machine machine(Machine::MODEL_128K);
+    for (int f = 0; f < 200; f++)
+        machine.run_frame();
+
+    FrameQueue frames;
+    ScreenRenderer renderer(&frames);
+    for (int scale : { 1, 2, 4 }) {
+        renderer.set_scale(scale);
+        for (bool full : { true, false }) {
+            report("static screen", QString("128K menu %1x %2").arg(scale)
+                                    .arg(full ? "full redraw" : "dirty cells"),
+                   "frames/s", ops_per_second([&](uint64_t n) {
+                for (uint64_t i = 0; i < n; i++) {
+                    machine.run_frame();
+                    if (full)
+                        machine.bus()->invalidate_screen();
+                    machine.capture_frame(frames.production_frame());
+                    frames.publish();
+                    renderer.render(*frames.consume());
+                }
+            }));
+        }
+    }
+}
+
+// --- Загрузка с ленты ---------------------------------------------------
+
+// Блок .tap: длина, флаг, данные, контрольная сумма
+static void tap_block(QByteArray &tap, uint8_t flag, const QByteArray &data)
+{
+    int size = data.size() + 2;
+    tap.append(char(size & 0xFF));
+    tap.append(char(size >> 8));
+    tap.append(char(flag));
+    uint8_t parity = flag;
+    for (char byte : data)
+        parity ^= uint8_t(byte);
+    tap.append(data);
+    tap.append(char(parity));
+}
+
+// Экран через LD-BYTES настоящими импульсами (ловушка выключена):
+// во сколько раз быстрее реального времени, без ускорения загрузчика
+// и с ним
+static void bench_tape()
+{
+    QByteArray screen(6912, 0);
+    for (int i = 0; i < screen.size(); i++)
+        screen[i] = char(i * 7 + (i >> 5));
+    QByteArray tap;
+    tap_block(tap, 0xFF, screen);
+    QString file = QDir::temp().filePath("bench_suite.tap");
+    {
+        QFile out(file);
+        if (not out.open(QIODevice::WriteOnly))
+            return;
+        out.write(tap);
+    }
+
+    // SCF, LD A,FF, LD IX,4000, LD DE,1B00, CALL LD-BYTES, JR $
+    static const uint8_t code[] = { 0x37, 0x3E, 0xFF, 0xDD, 0x21, 0x00, 0x40,
+                                    0x11, 0x00, 0x1B, 0xCD, 0x56, 0x05, 0x18, 0xFE };
+    for (bool accelerate : { false, true }) {
+        Machine machine(Machine::MODEL_48K);
+        machine.set_tape_traps(false);
+        machine.set_loader_acceleration(accelerate);
+        for (int f = 0; f < 100; f++)
+            machine.run_frame();
+        for (size_t i = 0; i < sizeof(code); i++)
+            machine.bus()->mem_write8(uint32_t(0x8000 + i), code[i]);
+        machine.cpu().state.pc = 0x8000;
+        if (not machine.load_tape(file))
+            break;
+        machine.tape().play();
+
+        int frames = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (machine.tape().playing()) {
+            machine.run_frame();
+            frames++;
+        }
+        double seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+        double emulated = frames / machine.bus()->timing().frame_rate();
+        report("tape", accelerate ? "ROM loader, accelerated" : "ROM loader",
+               "x realtime", emulated / seconds);
+    }
+    QFile::remove(file);
+}
+
+// --- Кадры целиком -------------------------------------------------------
+
+static void bench_snapshots()
+{
+    QStringList files;
+    for (const QString &sub : { QString("sna"), QString("assets/sna") }) {
+        QDir d(sub);
+        for (const QString &name : d.entryList({ "*.sna", "*.z80" }, QDir::Files, QDir::Name))
+            files << sub + "/" + name;
+    }
+
+    for (const QString &file : files) {
+        for (bool jit : { false, true }) {
+            Machine machine(Machine::MODEL_48K);
+            machine.set_jit(jit);
+            bool loaded = file.endsWith(".z80", Qt::CaseInsensitive)
+                    ? machine.load_z80(file)
+                    : machine.load_sna(file);
+            if (not loaded)
+                continue;
+
+            auto start = std::chrono::steady_clock::now();
+            for (int f = 0; f < SNAPSHOT_FRAMES; f++)
+                machine.run_frame();
+            double seconds = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start).count();
+            QString name = file + (jit ? " (Z80Jit)" : "");
+            report("frames", name, "frames/s", SNAPSHOT_FRAMES / seconds);
+            report("frames", name, "MHz", machine.cycles() / seconds / 1e6);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+
+    // Путь к JSON - относительно исходного каталога, а не каталога данных
+    QString output = argc > 2 ? QFileInfo(argv[2]).absoluteFilePath() : QString();
+    if (argc > 1)
+        QDir::setCurrent(argv[1]);
+
+    bench_mixes();
+    bench_buses();
+    bench_portfe();
+    bench_beeper();
+    bench_ay();
+    bench_render();
+    bench_static_screen();
+    bench_tape();
+    bench_snapshots();
+
+    QJsonObject build;
+    build["qt"] = QT_VERSION_STR;
+#if defined(__clang__)
+    build["compiler"] = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    build["compiler"] = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    build["compiler"] = QString("msvc %1").arg(_MSC_VER);
+#endif
+
+    QJsonObject root;
+    root["benchmark"] = "bench_suite";
+    root["version"] = 1;
+    root["build"] = build;
+    root["results"] = s_results;
+    QByteArray json = QJsonDocument(root).toJson();
+
+    if (not output.isEmpty()) {
+        QFile out(output);
+        if (not out.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "can't write %s\n", qPrintable(output));
+            return 1;
+        }
+        out.write(json);
+    } else {
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    }
+    return 0;
+}
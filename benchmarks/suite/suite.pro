@@ -0,0 +1,23 @@
+# Набор замеров ядра, шины, PortFE, звука (бипер, AY), отрисовки
+# ScreenRenderer и целых кадров на снапшотах. Результат - JSON для
+# сравнения между релизами.
+# Запуск: bench_suite [каталог с rom/ и sna/] [файл.json]
+# Без дисплея: QT_QPA_PLATFORM=offscreen bench_suite ...
+
+QT += core gui widgets
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = bench_suite
+
+include(../../core/core.pri)
+
+INCLUDEPATH += ../../app
+
+SOURCES += \
+    main.cpp \
+    ../../app/screenrenderer.cpp
+
+HEADERS += \
+    ../../app/screenrenderer.h
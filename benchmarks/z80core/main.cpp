@@ -0,0 +1,237 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "businterface48.h"
+#include "z80core.h"
+#include "z80jit.h"
+
+zusize z80_run_threaded(Z80 *cpu, zusize cycles); // threaded.cpp
+
+static constexpr int FRAME_CYCLES = 70000;
+static constexpr int INT_CYCLES = 28;
+
+static uint8_t s_mem_read(void *context, uint16_t address)
+{
+    return reinterpret_cast<BusInterface*>(context)->page_read8(address);
+}
+
+static void s_mem_write(void *context, uint16_t address, uint8_t value)
+{
+    reinterpret_cast<BusInterface*>(context)->page_write8(address, value);
+}
+
+static uint8_t s_port_read(void *context, uint16_t address)
+{
+    return reinterpret_cast<BusInterface*>(context)->io_read8(address);
+}
+
+static void s_port_write(void *context, uint16_t address, uint8_t value)
+{
+    reinterpret_cast<BusInterface*>(context)->io_write8(address, value);
+}
+
+static uint32_t s_int_data(void *context)
+{
+    Q_UNUSED(context);
+    return 0xC3000000; // JP #0
+}
+
+// Загрузка 48К снапшота .sna: PC снимается со стека, как после RETN.
+static bool load_sna(const QString &filename, Z80 &cpu, BusInterface &bus)
+{
+    QFile sna(filename);
+    if (!sna.open(QIODevice::ReadOnly))
+        return false;
+    QByteArray buffer = sna.readAll();
+    if (buffer.size() < 27 + 49152)
+        return false;
+
+    const uint8_t *h = reinterpret_cast<const uint8_t *>(buffer.constData());
+    auto w = [h](int off) { return uint16_t(h[off] | (h[off + 1] << 8)); };
+
+    z80_reset(&cpu);
+    cpu.state.i = h[0];
+    cpu.state.hl_.value_uint16 = w(1);
+    cpu.state.de_.value_uint16 = w(3);
+    cpu.state.bc_.value_uint16 = w(5);
+    cpu.state.af_.value_uint16 = w(7);
+    cpu.state.hl.value_uint16 = w(9);
+    cpu.state.de.value_uint16 = w(11);
+    cpu.state.bc.value_uint16 = w(13);
+    cpu.state.iy.value_uint16 = w(15);
+    cpu.state.ix.value_uint16 = w(17);
+    cpu.state.internal.iff1 = cpu.state.internal.iff2 = (h[19] >> 2) & 1;
+    cpu.state.r = h[20];
+    cpu.state.af.value_uint16 = w(21);
+    cpu.state.sp = w(23);
+    cpu.state.internal.im = h[25] & 3;
+    bus.io_write8(0xfe, h[26]);
+    for (int off = 0; off < 49152; off++)
+        bus.mem_write8(16384 + off, h[27 + off]);
+
+    cpu.state.pc = uint16_t(bus.mem_read8(cpu.state.sp) |
+                            (bus.mem_read8(cpu.state.sp + 1) << 8));
+    cpu.state.sp += 2;
+    return true;
+}
+
+// Синтетика для LDIR/CPIR: заливка и поиск по экрану в цикле.
+static bool load_blockops(const QString &, Z80 &cpu, BusInterface &bus)
+{
+    static const uint8_t code[] = {
+        0xF3,               // 8000 di
+        0x21, 0x00, 0x40,   // 8001 ld hl,#4000
+        0x11, 0x01, 0x40,   //      ld de,#4001
+        0x01, 0xFF, 0x1A,   //      ld bc,6911
+        0x77,               //      ld (hl),a
+        0xED, 0xB0,         //      ldir
+        0x3C,               //      inc a
+        0x21, 0x00, 0x40,   //      ld hl,#4000
+        0x01, 0x00, 0x1B,   //      ld bc,6912
+        0xED, 0xB1,         //      cpir
+        0x18, 0xE9          //      jr #8001
+    };
+    z80_reset(&cpu);
+    for (uint32_t i = 0; i < sizeof(code); i++)
+        bus.mem_write8(0x8000 + i, code[i]);
+    cpu.state.pc = 0x8000;
+    return true;
+}
+
+// Простой в HALT с прерываниями IM 1 в ПЗУ, как у большинства игр
+static bool load_halt(const QString &, Z80 &cpu, BusInterface &bus)
+{
+    static const uint8_t code[] = {
+        0xED, 0x56,         // 8000 im 1
+        0xFB,               // 8002 ei
+        0x76,               //      halt
+        0x18, 0xFC          //      jr #8002
+    };
+    z80_reset(&cpu);
+    for (uint32_t i = 0; i < sizeof(code); i++)
+        bus.mem_write8(0x8000 + i, code[i]);
+    cpu.state.pc = 0x8000;
+    cpu.state.sp = 0xFF00;
+    cpu.state.iy.value_uint16 = 0x5C3A;
+    return true;
+}
+
+struct Result
+{
+    double seconds;
+    uint64_t cycles;
+};
+
+template <class Run>
+static Result run_frames(Z80 &cpu, int frames, Run run)
+{
+    uint64_t cycles = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; f++) {
+        cycles += run(&cpu, FRAME_CYCLES - INT_CYCLES);
+        z80_int(&cpu, 1);
+        cycles += run(&cpu, INT_CYCLES);
+        z80_int(&cpu, 0);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return { std::chrono::duration<double>(stop - start).count(), cycles };
+}
+
+static void setup(Z80 &cpu, BusInterface &bus)
+{
+    std::memset(&cpu, 0, sizeof(cpu));
+    cpu.context = &bus;
+    cpu.read = s_mem_read;
+    cpu.write = s_mem_write;
+    cpu.in = s_port_read;
+    cpu.out = s_port_write;
+    cpu.int_data = s_int_data;
+    cpu.halt = nullptr;
+}
+
+static bool same_machine(const Z80 &a, BusInterface &abus, const Z80 &b, BusInterface &bbus)
+{
+    if (std::memcmp(&a.state, &b.state, sizeof(a.state)) != 0)
+        return false;
+    for (uint32_t addr = 0; addr < 0x10000; addr++)
+        if (abus.mem_read8(addr) != bbus.mem_read8(addr))
+            return false;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc > 1)
+        QDir::setCurrent(argv[1]);
+    int frames = argc > 2 ? atoi(argv[2]) : 2000;
+
+    struct Workload
+    {
+        const char *name;
+        bool (*load)(const QString &, Z80 &, BusInterface &);
+    };
+    const Workload workloads[] = {
+        { "sna/river.sna", load_sna },
+        { "sna/r-type.sna", load_sna },
+        { "ldir/cpir loop", load_blockops },
+        { "halt loop", load_halt },
+    };
+    int status = 0;
+
+    std::printf("%-18s %12s %12s %12s %12s\n",
+                "snapshot", "C API, MHz", "threaded", "Z80Core", "Z80Jit");
+    for (const Workload &w : workloads) {
+        const char *name = w.name;
+        BusInterface48 bus_c, bus_g, bus_t, bus_j;
+        Z80 cpu_c, cpu_g, cpu_t, cpu_j;
+        setup(cpu_c, bus_c);
+        setup(cpu_g, bus_g);
+        setup(cpu_t, bus_t);
+        setup(cpu_j, bus_j);
+        if (!w.load(name, cpu_c, bus_c) || !w.load(name, cpu_g, bus_g) ||
+                !w.load(name, cpu_t, bus_t) || !w.load(name, cpu_j, bus_j)) {
+            std::fprintf(stderr, "%s: can't load\n", name);
+            status = 1;
+            continue;
+        }
+        Z80Jit jit(&bus_j);
+
+        Result c = run_frames(cpu_c, frames, z80_run);
+        Result g = run_frames(cpu_g, frames, z80_run_threaded);
+        Result t = run_frames(cpu_t, frames, Z80Core<BusInterface48>::run);
+        Result j = run_frames(cpu_j, frames, [&jit](Z80 *cpu, zusize cycles) {
+            return jit.run(cpu, cycles);
+        });
+
+        std::printf("%-18s %12.1f %12.1f %12.1f %12.1f\n", name,
+                    c.cycles / c.seconds / 1e6,
+                    g.cycles / g.seconds / 1e6,
+                    t.cycles / t.seconds / 1e6,
+                    j.cycles / j.seconds / 1e6);
+        std::printf("%-18s Z80Jit: %llu blocks (%llu native), %llu invalidations\n", "",
+                    (unsigned long long)jit.stats().translated,
+                    (unsigned long long)jit.stats().native,
+                    (unsigned long long)jit.stats().invalidated);
+
+        // Все ядра обязаны прийти в одно и то же состояние
+        if (g.cycles != c.cycles || !same_machine(cpu_c, bus_c, cpu_g, bus_g)) {
+            std::fprintf(stderr, "%s: threaded core diverged after %d frames\n", name, frames);
+            status = 1;
+        }
+        if (t.cycles != c.cycles || !same_machine(cpu_c, bus_c, cpu_t, bus_t)) {
+            std::fprintf(stderr, "%s: Z80Core diverged after %d frames\n", name, frames);
+            status = 1;
+        }
+        if (j.cycles != c.cycles || !same_machine(cpu_c, bus_c, cpu_j, bus_j)) {
+            std::fprintf(stderr, "%s: Z80Jit diverged after %d frames\n", name, frames);
+            status = 1;
+        }
+    }
+    return status;
+}
@@ -0,0 +1,19 @@
+#include "emulation/CPU/Z80.h"
+
+#include <Z/macros/value.h>
+#include <Z/macros/pointer.h>
+
+// C-ядро с потоковой диспетчеризацией, собранное рядом с обычным, чтобы
+// сравнить их в одном процессе независимо от CONFIG+=z80_threaded.
+#ifndef CPU_Z80_THREADED_DISPATCH
+#define CPU_Z80_THREADED_DISPATCH
+#endif
+
+namespace z80_threaded {
+#include "../../3rdparty/Z80/sources/Z80.c"
+}
+
+zusize z80_run_threaded(Z80 *cpu, zusize cycles)
+{
+    return z80_threaded::z80_run(cpu, cycles);
+}
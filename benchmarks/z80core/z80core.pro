@@ -0,0 +1,16 @@
+# Сравнение C-ядра Z80, его потоковой (computed goto) версии
+# ядра, специализированного под шину, и кэша трансляции Z80Jit.
+# Запуск: bench_z80core [каталог с rom/ и sna/] [кадров]
+
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = bench_z80core
+
+include(../../core/core.pri)
+
+SOURCES += \
+    main.cpp \
+    threaded.cpp
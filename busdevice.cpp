@@ -1,6 +0,0 @@
-#include "busdevice.h"
-
-BusDevice::BusDevice(QObject *parent) : QObject(parent)
-{
-
-}
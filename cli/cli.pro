@@ -0,0 +1,15 @@
+# Запуск эмулятора без окна: снапшот, N кадров без таймера на полной
+# скорости, затем кадры/с, эмулируемые МГц, хэш экрана и регистры.
+# Запуск: speccy-cli --help
+
+QT = core
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = speccy-cli
+
+include(../core/core.pri)
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,133 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <chrono>
+#include <cstdio>
+
+#include "framepacer.h"
+#include "machine.h"
+
+// Экран 256x192 с атрибутами, как в .scr
+static constexpr int SCREEN_SIZE = 6912;
+
+// FNV-1a: хватает, чтобы заметить любое изменение картинки
+static uint32_t fnv1a(const uint8_t *data, int size)
+{
+    uint32_t hash = 2166136261u;
+    for (int i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void print_state(const QString &name, const Machine &machine)
+{
+    const ZZ80State &s = machine.cpu().state;
+    std::printf("%s: screen %08x"
+                " AF=%04x BC=%04x DE=%04x HL=%04x"
+                " AF'=%04x BC'=%04x DE'=%04x HL'=%04x"
+                " IX=%04x IY=%04x SP=%04x PC=%04x I=%02x R=%02x"
+                " IM=%d IFF=%d/%d\n",
+                qPrintable(name),
+                fnv1a(machine.bus()->framebuffer(), SCREEN_SIZE),
+                s.af.value_uint16, s.bc.value_uint16,
+                s.de.value_uint16, s.hl.value_uint16,
+                s.af_.value_uint16, s.bc_.value_uint16,
+                s.de_.value_uint16, s.hl_.value_uint16,
+                s.ix.value_uint16, s.iy.value_uint16, s.sp, s.pc, s.i, s.r,
+                s.internal.im, s.internal.iff1, s.internal.iff2);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("speccy-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                "Runs snapshots headless for a number of frames at full speed "
+                "(or at the real frame rate with --realtime) "
+                "and prints the speed, the screen hash and the registers.");
+    parser.addHelpOption();
+    QCommandLineOption model_option({"m", "model"}, "Machine model: 48 or 128.", "model", "48");
+    QCommandLineOption rom_option({"r", "rom"}, "ROM file (default: rom/<model>.rom).", "file");
+    QCommandLineOption frames_option({"f", "frames"}, "Frames to run.", "n", "500");
+    QCommandLineOption jit_option("jit", "Run hot code through Z80Jit.");
+    QCommandLineOption no_jit_option("no-jit", "Interpreter only.");
+    QCommandLineOption hash_option("hash-only", "Skip the timing lines (for golden output diffs).");
+    QCommandLineOption realtime_option("realtime",
+                                       "Pace frames at the model's rate (50.08 Hz for 48K) and "
+                                       "print the frame start jitter histogram.");
+    parser.addOptions({ model_option, rom_option, frames_option,
+                        jit_option, no_jit_option, hash_option, realtime_option });
+    parser.addPositionalArgument("snapshots", "Snapshots to run (.sna, .z80).", "snapshot...");
+    parser.process(app);
+
+    Machine::Model model;
+    if (parser.value(model_option) == "48")
+        model = Machine::MODEL_48K;
+    else if (parser.value(model_option) == "128")
+        model = Machine::MODEL_128K;
+    else {
+        std::fprintf(stderr, "unknown model: %s\n", qPrintable(parser.value(model_option)));
+        return 2;
+    }
+
+    bool ok = false;
+    int frames = parser.value(frames_option).toInt(&ok);
+    if (not ok or frames < 0) {
+        std::fprintf(stderr, "bad frame count: %s\n", qPrintable(parser.value(frames_option)));
+        return 2;
+    }
+
+    const QStringList snapshots = parser.positionalArguments();
+    if (snapshots.isEmpty())
+        parser.showHelp(2);
+
+    int status = 0;
+    for (const QString &snapshot : snapshots) {
+        // Каждый снапшот - на только что включённой машине
+        Machine machine(model, parser.value(rom_option));
+        if (not machine.error().isEmpty()) {
+            std::fprintf(stderr, "%s\n", qPrintable(machine.error()));
+            return 1;
+        }
+        if (parser.isSet(jit_option))
+            machine.set_jit(true);
+        if (parser.isSet(no_jit_option))
+            machine.set_jit(false);
+
+        QString suffix = QFileInfo(snapshot).suffix().toLower();
+        bool loaded = suffix == "z80" ? machine.load_z80(snapshot)
+                                      : machine.load_sna(snapshot);
+        if (not loaded) {
+            std::fprintf(stderr, "%s\n", qPrintable(machine.error()));
+            status = 1;
+            continue;
+        }
+
+        uint64_t start_cycles = machine.cycles();
+        FramePacer pacer(machine.bus()->timing().frame_rate());
+        auto start = std::chrono::steady_clock::now();
+        for (int f = 0; f < frames; f++) {
+            if (parser.isSet(realtime_option))
+                pacer.wait();
+            machine.run_frame();
+        }
+        auto stop = std::chrono::steady_clock::now();
+
+        if (not parser.isSet(hash_option)) {
+            double seconds = std::chrono::duration<double>(stop - start).count();
+            double cycles = double(machine.cycles() - start_cycles);
+            std::printf("%s: %d frames in %.3f s, %.1f fps, %.1f MHz\n",
+                        qPrintable(snapshot), frames, seconds,
+                        seconds > 0 ? frames / seconds : 0.0,
+                        seconds > 0 ? cycles / seconds / 1e6 : 0.0);
+        }
+        if (parser.isSet(realtime_option))
+            std::printf("%s", qPrintable(pacer.summary()));
+        print_state(snapshot, machine);
+    }
+    return status;
+}
@@ -0,0 +1,68 @@
+#ifndef AUDIORING_H
+#define AUDIORING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+// Сэмплы от эмуляции к звуковому устройству: кольцо на SIZE сэмплов
+// (степень двойки), один поток пишет, один читает, без блокировок.
+// В отличие от RingQueue пишется и читается блоками произвольной длины:
+// кадр звука - сотни сэмплов, устройство забирает сколько ему удобно.
+template <int SIZE>
+class AudioRing
+{
+    static_assert((SIZE & (SIZE - 1)) == 0, "SIZE must be a power of two");
+
+public:
+    // Сколько сэмплов лежит в кольце; из любого потока
+    int fill() const
+    { return int(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire)); }
+    static constexpr int capacity() { return SIZE; }
+
+    // Сторона эмуляции. Не влезшее отбрасывается; возвращает записанное
+    int write(const int16_t *samples, int count)
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        uint32_t tail = _tail.load(std::memory_order_acquire);
+        count = std::min(count, int(SIZE - (head - tail)));
+        copy_in(_samples, head, samples, count);
+        _head.store(head + uint32_t(count), std::memory_order_release);
+        return count;
+    }
+
+    // Сторона устройства; возвращает прочитанное
+    int read(int16_t *samples, int count)
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        uint32_t head = _head.load(std::memory_order_acquire);
+        count = std::min(count, int(head - tail));
+        copy_out(_samples, tail, samples, count);
+        _tail.store(tail + uint32_t(count), std::memory_order_release);
+        return count;
+    }
+
+private:
+    // Кольцо с позиции at <-> линейный буфер; через край кольца - в два куска
+    static void copy_in(int16_t *ring, uint32_t at, const int16_t *from, int count)
+    {
+        uint32_t start = at & (SIZE - 1);
+        int first = std::min(count, int(SIZE - start));
+        std::memcpy(ring + start, from, size_t(first) * sizeof(int16_t));
+        std::memcpy(ring, from + first, size_t(count - first) * sizeof(int16_t));
+    }
+    static void copy_out(const int16_t *ring, uint32_t at, int16_t *to, int count)
+    {
+        uint32_t start = at & (SIZE - 1);
+        int first = std::min(count, int(SIZE - start));
+        std::memcpy(to, ring + start, size_t(first) * sizeof(int16_t));
+        std::memcpy(to + first, ring, size_t(count - first) * sizeof(int16_t));
+    }
+
+    int16_t _samples[SIZE] {};
+    std::atomic<uint32_t> _head { 0 };  // пишет эмуляция
+    std::atomic<uint32_t> _tail { 0 };  // пишет устройство
+};
+
+#endif // AUDIORING_H
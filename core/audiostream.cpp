@@ -0,0 +1,55 @@
+#include "audiostream.h"
+#include <algorithm>
+
+void AudioStream::set_sample_rate(int rate)
+{
+    _sample_rate = rate;
+    set_latency_ms(_latency_ms);
+}
+
+void AudioStream::set_latency_ms(int ms)
+{
+    _latency_ms = ms;
+    _target = std::min(_sample_rate * ms / 1000, SIZE * 3 / 4);
+}
+
+void AudioStream::write(const int16_t *samples, int count)
+{
+    int written = _ring.write(samples, count);
+    if (written < count)
+        _dropped += uint64_t(count - written);
+}
+
+// ПИ-регулятор по сглаженному заполнению. Пропорциональная часть
+// гасит колебания, интегральная набирает постоянный уход часов
+// (десятые доли процента), чтобы заполнение держалось на цели, а не ниже
+double AudioStream::rate_adjust()
+{
+    _average_fill += (fill() - _average_fill) * FILL_SMOOTHING;
+    double target = _target;
+    double error = std::max(-1.0, std::min(1.0, (target - _average_fill) / target));
+    _integral = std::max(-MAX_ADJUST, std::min(MAX_ADJUST, _integral + INTEGRAL_GAIN * error));
+    _adjust = 1.0 + std::max(-MAX_ADJUST, std::min(MAX_ADJUST, MAX_ADJUST * error + _integral));
+    return _adjust;
+}
+
+int AudioStream::read(int16_t *samples, int count)
+{
+    if (_priming) {
+        if (fill() < _target)
+            return 0;
+        _priming = false;
+    }
+    int got = _ring.read(samples, count);
+    if (got < count) {
+        _underruns++;
+        _priming = true;
+    }
+    return got;
+}
+
+void AudioStream::clear_stats()
+{
+    _underruns = 0;
+    _dropped = 0;
+}
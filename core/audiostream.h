@@ -0,0 +1,62 @@
+#ifndef AUDIOSTREAM_H
+#define AUDIOSTREAM_H
+
+#include <atomic>
+#include "audioring.h"
+
+// Звук от эмуляции к устройству с подстройкой темпа (dynamic rate
+// control). Кадры идут по часам FramePacer, устройство забирает сэмплы
+// по своим, и без подстройки кольцо медленно пустеет или переполняется.
+// Поэтому после каждого кадра эмуляция спрашивает rate_adjust() и
+// синтезирует следующий кадр на долю процента быстрее или медленнее,
+// чтобы заполнение держалось около latency_ms().
+//
+// Устройство начинает (и после опустошения - продолжает) читать, только
+// когда в кольце набралось latency_ms(): так один провал не превращается
+// в треск на каждом чтении. Один поток пишет, один читает.
+class AudioStream
+{
+public:
+    static constexpr int SIZE = 8192;               // ~170 мс при 48 кГц
+    static constexpr double MAX_ADJUST = 0.005;     // +-0.5 % частоты
+    static constexpr double FILL_SMOOTHING = 0.05;  // вес кадра в среднем
+    static constexpr double INTEGRAL_GAIN = 0.0001; // за кадр при ошибке 100 %
+
+    // Из GUI до начала вывода
+    void set_sample_rate(int rate);
+    // Целевая задержка в кольце; из любого потока
+    void set_latency_ms(int ms);
+    int latency_ms() const { return _latency_ms; }
+
+    // Сторона эмуляции: сэмплы кадра и множитель частоты синтеза
+    // для следующего кадра (Machine::set_rate_adjust)
+    void write(const int16_t *samples, int count);
+    double rate_adjust();
+
+    // Сторона устройства: отдаёт прочитанное, 0 - копим до цели
+    int read(int16_t *samples, int count);
+
+    // Счётчики; из любого потока
+    int fill() const { return _ring.fill(); }
+    int target() const { return _target; }
+    double adjust() const { return _adjust; }
+    uint64_t underruns() const { return _underruns; }
+    uint64_t dropped() const { return _dropped; }
+    void clear_stats();
+
+private:
+    AudioRing<SIZE> _ring;
+    std::atomic<int> _sample_rate { 48000 };
+    std::atomic<int> _latency_ms { 40 };
+    std::atomic<int> _target { 1920 };              // сэмплов
+
+    double _average_fill { 0 };                     // поток эмуляции
+    double _integral { 0 };
+    bool _priming { true };                         // поток устройства
+
+    std::atomic<double> _adjust { 1.0 };
+    std::atomic<uint64_t> _underruns { 0 };
+    std::atomic<uint64_t> _dropped { 0 };
+};
+
+#endif // AUDIOSTREAM_H
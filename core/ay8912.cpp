@@ -0,0 +1,234 @@
+#include "ay8912.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AY_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AY_NEON
+#include <arm_neon.h>
+#endif
+
+// Буфер шагов: кадр 128К - 4432 шага, с запасом на длинный кадр
+static constexpr int STEP_BUFFER = 8192;
+static constexpr int DC_SHIFT = 10;
+
+// Громкость уровней 0..15 (шкала ЦАП AY - примерно 3 дБ на уровень),
+// в долях CHANNEL_MAX
+static const int16_t s_volume[16] = {
+    0, 41, 59, 86, 126, 187, 264, 440, 519, 840, 1197, 1527, 2017, 2602, 3300, 4096
+};
+
+// Маски значащих битов регистров
+static const uint8_t s_register_mask[16] = {
+    0xff, 0x0f, 0xff, 0x0f, 0xff, 0x0f, 0x1f, 0xff,
+    0x1f, 0x1f, 0x1f, 0xff, 0xff, 0x0f, 0xff, 0xff
+};
+
+enum {
+    ENVELOPE_HOLD = 1,
+    ENVELOPE_ALT  = 2,
+    ENVELOPE_ATT  = 4,
+    ENVELOPE_CONT = 8
+};
+
+AY8912::AY8912()
+{
+    for (std::vector<int16_t> &channel : _channels)
+        channel.resize(STEP_BUFFER);
+    _mixed.resize(STEP_BUFFER);
+    reset();
+}
+
+void AY8912::reset()
+{
+    for (int reg = 0; reg < 16; reg++)
+        write_register(reg, 0);
+    _selected = 0;
+    _noise_rng = 1;
+}
+
+uint8_t AY8912::read8(uint32_t address)
+{
+    Q_UNUSED(address);
+    return _state.registers[_selected];
+}
+
+// A14 = 1: FFFD - выбор регистра, A14 = 0: BFFD - данные
+void AY8912::write8(uint32_t address, uint8_t value)
+{
+    if (address & 0x4000)
+        _selected = value & 0x0f;
+    else
+        write_register(_selected, value);
+}
+
+void AY8912::write_register(int reg, uint8_t value)
+{
+    _state.registers[reg] = value & s_register_mask[reg];
+    if (reg == Z_AY_3_891X_ENVELOPE_SHAPE_CYCLE) {
+        _envelope_count = 0;
+        _envelope_step = 0;
+        _envelope_invert = value & ENVELOPE_ATT ? 0 : 15;
+        _envelope_hold = false;
+        _envelope_level = _envelope_invert;
+    }
+}
+
+void AY8912::set_clock(uint32_t cpu_hz, uint32_t chip_hz, int sample_rate, uint64_t start)
+{
+    _step_cycles = (uint64_t(cpu_hz) * STEP_CLOCKS << 16) / chip_hz;
+    _next_step = (start << 16) + _step_cycles;
+    _steps = 0;
+    double steps_per_second = double(chip_hz) / STEP_CLOCKS;
+    _base_steps_per_sample = _steps_per_sample
+            = int64_t(steps_per_second / sample_rate * 4294967296.0);
+    _window_left = _steps_per_sample;
+    _window_sum = 0;
+    _window_steps = 0;
+    _samples.clear();
+}
+
+// Сэмплов на секунду больше в factor раз - шагов на сэмпл меньше
+void AY8912::set_adjust(double factor)
+{
+    _steps_per_sample = int64_t(double(_base_steps_per_sample) / factor);
+}
+
+void AY8912::update(uint64_t now)
+{
+    uint64_t at = now << 16;
+    if (at < _next_step)
+        return;
+    uint64_t steps = (at - _next_step) / _step_cycles + 1;
+    _next_step += steps * _step_cycles;
+    while (steps) {
+        int chunk = int(std::min<uint64_t>(steps, uint64_t(STEP_BUFFER - _steps)));
+        run(chunk);
+        steps -= uint64_t(chunk);
+        if (_steps == STEP_BUFFER)
+            flush();
+    }
+}
+
+void AY8912::run(int steps)
+{
+    const uint8_t *r = _state.registers;
+    int tone_period[3];
+    int tone_off[3], noise_off[3];
+    int volume[3];
+    bool envelope[3];
+    for (int c = 0; c < 3; c++) {
+        tone_period[c] = std::max(1, r[c * 2] | (r[c * 2 + 1] << 8));
+        tone_off[c] = (r[Z_AY_3_891X_ENABLEE] >> c) & 1;
+        noise_off[c] = (r[Z_AY_3_891X_ENABLEE] >> (c + 3)) & 1;
+        volume[c] = s_volume[r[Z_AY_3_891X_CHANNEL_A_AMPLITUDE + c] & 15];
+        envelope[c] = r[Z_AY_3_891X_CHANNEL_A_AMPLITUDE + c] & 16;
+    }
+    const int noise_period = std::max(1, int(r[Z_AY_3_891X_NOISE_PERIOD]));
+    // Шаг огибающей - 16 тактов микросхемы на единицу периода
+    const int envelope_period = 2 * std::max(1, r[Z_AY_3_891X_ENVELOPE_PERIOD_FINE_TUNE]
+                                                | (r[Z_AY_3_891X_ENVELOPE_PERIOD_COARSE_TUNE] << 8));
+    const int shape = r[Z_AY_3_891X_ENVELOPE_SHAPE_CYCLE];
+
+    int16_t *out[3] = { &_channels[0][size_t(_steps)], &_channels[1][size_t(_steps)],
+                        &_channels[2][size_t(_steps)] };
+    for (int s = 0; s < steps; s++) {
+        for (int c = 0; c < 3; c++) {
+            if (++_tone_count[c] >= tone_period[c]) {
+                _tone_count[c] = 0;
+                _tone_out[c] ^= 1;
+            }
+        }
+        _noise_half = not _noise_half;
+        if (_noise_half and ++_noise_count >= noise_period) {
+            _noise_count = 0;
+            // 17-битный сдвиговый регистр с обратной связью от битов 0 и 3
+            _noise_rng = (_noise_rng >> 1) | (((_noise_rng ^ (_noise_rng >> 3)) & 1) << 16);
+        }
+        if (++_envelope_count >= envelope_period) {
+            _envelope_count = 0;
+            if (not _envelope_hold and ++_envelope_step > 15) {
+                if (not (shape & ENVELOPE_CONT)) {
+                    _envelope_hold = true;
+                    _envelope_level = 0;
+                } else if (shape & ENVELOPE_HOLD) {
+                    _envelope_hold = true;
+                    _envelope_level = shape & ENVELOPE_ALT ? _envelope_invert : 15 ^ _envelope_invert;
+                } else {
+                    if (shape & ENVELOPE_ALT)
+                        _envelope_invert ^= 15;
+                    _envelope_step = 0;
+                }
+            }
+            if (not _envelope_hold)
+                _envelope_level = _envelope_step ^ _envelope_invert;
+        }
+
+        int noise = _noise_rng & 1;
+        for (int c = 0; c < 3; c++) {
+            int on = (_tone_out[c] | tone_off[c]) & (noise | noise_off[c]);
+            int amplitude = envelope[c] ? s_volume[_envelope_level] : volume[c];
+            out[c][s] = int16_t(on ? amplitude : 0);
+        }
+    }
+    _steps += steps;
+}
+
+void AY8912::mix(const int16_t *a, const int16_t *b, const int16_t *c,
+                 int16_t *out, int count)
+{
+    int i = 0;
+#if defined(AY_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        __m128i sum = _mm_add_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)),
+                                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+        sum = _mm_add_epi16(sum, _mm_loadu_si128(reinterpret_cast<const __m128i *>(c + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), sum);
+    }
+#elif defined(AY_NEON)
+    for (; i + 8 <= count; i += 8)
+        vst1q_s16(out + i, vaddq_s16(vaddq_s16(vld1q_s16(a + i), vld1q_s16(b + i)),
+                                     vld1q_s16(c + i)));
+#endif
+    for (; i < count; i++)
+        out[i] = int16_t(a[i] + b[i] + c[i]);
+}
+
+// Сложить накопленные шаги и усреднить окнами по сэмплу вывода
+void AY8912::flush()
+{
+    mix(_channels[0].data(), _channels[1].data(), _channels[2].data(), _mixed.data(), _steps);
+    for (int s = 0; s < _steps; s++) {
+        _window_sum += _mixed[size_t(s)];
+        _window_steps++;
+        _window_left -= int64_t(1) << 32;
+        if (_window_left <= 0) {
+            int32_t sample = _window_sum / _window_steps;
+            _dc += sample - (_dc >> DC_SHIFT);
+            _last = int16_t(sample - (_dc >> DC_SHIFT));
+            _samples.push_back(_last);
+            _window_left += _steps_per_sample;
+            _window_sum = 0;
+            _window_steps = 0;
+        }
+    }
+    _steps = 0;
+}
+
+void AY8912::end_frame(uint64_t end, int16_t *out, int count)
+{
+    update(end);
+    flush();
+
+    int ready = std::min(count, int(_samples.size()));
+    for (int i = 0; i < count; i++) {
+        int sample = out[i] + (i < ready ? _samples[size_t(i)] : _last);
+        out[i] = int16_t(std::max(-32768, std::min(32767, sample)));
+    }
+    _samples.erase(_samples.begin(), _samples.begin() + ready);
+    // Часы AY и бипера считают сэмплы каждый сам: расхождение - доли
+    // сэмпла, но копиться ему нельзя
+    if (_samples.size() > 4)
+        _samples.erase(_samples.begin(), _samples.end() - 1);
+}
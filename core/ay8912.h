@@ -0,0 +1,88 @@
+#ifndef AY8912_H
+#define AY8912_H
+
+#include <Z/hardware/PSG/General Instrument/AY-3-891x.h>
+#include <vector>
+#include "busdevice.h"
+
+// Музыкальный сопроцессор 128К: три канала тона, шум и огибающая.
+// Регистры - ZAY3891xState из Z (AY-3-891x.h). Порты: запись в FFFD
+// выбирает регистр, чтение FFFD читает его, запись в BFFD пишет.
+//
+// Генератор шагает с частотой микросхемы / 8 и догоняет время лениво:
+// перед каждой записью в регистр (update) и в конце кадра. За шаг
+// каждый канал кладёт свою амплитуду в буфер кадра; в конце кадра
+// буферы складываются векторно (SSE2/NEON) и усредняются окнами до
+// частоты вывода.
+class AY8912 : public BusDevice
+{
+public:
+    static constexpr int STEP_CLOCKS = 8;       // тактов микросхемы на шаг
+    static constexpr int CHANNEL_MAX = 4096;    // амплитуда канала на 15
+
+    AY8912();
+
+    uint8_t read8(uint32_t address) override;
+    void write8(uint32_t address, uint8_t value) override;
+
+    void reset();
+    const ZAY3891xState & state() const { return _state; }
+
+    // Частоты CPU, микросхемы и вывода; отсчёт времени с такта start
+    void set_clock(uint32_t cpu_hz, uint32_t chip_hz, int sample_rate, uint64_t start);
+
+    // Подстройка частоты вывода, как Beeper::set_adjust
+    void set_adjust(double factor);
+
+    // Догнать генератор до такта now
+    void update(uint64_t now);
+
+    // Кадр закончился в такте end: добавить звук в count сэмплов out
+    // (столько же выдал Beeper за кадр)
+    void end_frame(uint64_t end, int16_t *out, int count);
+
+    // Сложение трёх каналов - отдельно для бенчмарка
+    static void mix(const int16_t *a, const int16_t *b, const int16_t *c,
+                    int16_t *out, int count);
+
+private:
+    void write_register(int reg, uint8_t value);
+    void run(int steps);
+    void flush();
+
+    ZAY3891xState _state {};
+    int _selected { 0 };
+
+    // Генератор
+    int _tone_count[3] {};
+    int _tone_out[3] {};
+    int _noise_count { 0 };
+    bool _noise_half { false };     // шум шагает вдвое медленнее тона
+    uint32_t _noise_rng { 1 };
+    int _envelope_count { 0 };
+    int _envelope_step { 0 };       // 0..15 внутри цикла
+    int _envelope_invert { 0 };     // 0 - нарастание, 15 - спад
+    bool _envelope_hold { false };
+    int _envelope_level { 0 };
+
+    // Время: шаги в тактах CPU, 16.16
+    uint64_t _step_cycles { 16 << 16 };
+    uint64_t _next_step { 0 };
+
+    // Амплитуды каналов и их сумма по шагам незакрытого кадра
+    std::vector<int16_t> _channels[3];
+    std::vector<int16_t> _mixed;
+    int _steps { 0 };
+
+    // Понижение частоты: шагов на сэмпл (32.32) и окно текущего сэмпла
+    int64_t _base_steps_per_sample { 0 };
+    int64_t _steps_per_sample { 0 };
+    int64_t _window_left { 0 };     // шагов до конца окна, 32.32
+    int32_t _window_sum { 0 };
+    int _window_steps { 0 };
+    std::vector<int16_t> _samples;  // готовые, ещё не отданные в кадр
+    int32_t _dc { 0 };              // постоянная составляющая, << DC_SHIFT
+    int16_t _last { 0 };
+};
+
+#endif // AY8912_H
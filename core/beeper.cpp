@@ -0,0 +1,102 @@
+#include "beeper.h"
+#include <algorithm>
+#include <cmath>
+
+constexpr int Beeper::LEVELS[4];
+
+static constexpr double PI = 3.14159265358979323846;
+// Срез чуть ниже Найквиста: переходная полоса окна Блэкмана на 16 отводов
+static constexpr double CUTOFF = 0.9;
+// Постоянная фильтра постоянной составляющей: 2^-DC_SHIFT за сэмпл
+static constexpr int DC_SHIFT = 10;
+
+Beeper::Beeper(int sample_rate, uint32_t cpu_hz)
+{
+    for (int phase = 0; phase < PHASES; phase++) {
+        double frac = double(phase) / PHASES;
+        double taps[TAPS];
+        double total = 0;
+        for (int k = 0; k < TAPS; k++) {
+            double x = k - (TAPS / 2 - 1) - frac;      // от центра импульса
+            double sinc = x == 0 ? 1.0 : std::sin(PI * CUTOFF * x) / (PI * CUTOFF * x);
+            double w = (k + 1 - frac) / TAPS;           // 0..1 по окну
+            double window = 0.42 - 0.5 * std::cos(2 * PI * w) + 0.08 * std::cos(4 * PI * w);
+            taps[k] = sinc * std::max(window, 0.0);
+            total += taps[k];
+        }
+        // Сумма каждой фазы - ровно KERNEL_ONE: ступенька приходит на
+        // свой уровень без остатка, который копился бы в _sum
+        int sum = 0;
+        for (int k = 0; k < TAPS; k++) {
+            _kernel[phase][k] = int16_t(std::lround(taps[k] / total * KERNEL_ONE));
+            sum += _kernel[phase][k];
+        }
+        _kernel[phase][TAPS / 2 - 1] += int16_t(KERNEL_ONE - sum);
+    }
+    set_rate(sample_rate, cpu_hz);
+}
+
+void Beeper::set_rate(int sample_rate, uint32_t cpu_hz)
+{
+    _sample_rate = sample_rate;
+    _base_step = _step = uint64_t(double(sample_rate) / cpu_hz * 4294967296.0);
+    // Два кадра с запасом на хвосты импульсов
+    _acc.assign(size_t(sample_rate / 25 + 2 * TAPS), 0);
+    reset(_start, _level);
+}
+
+void Beeper::set_adjust(double factor)
+{
+    _step = uint64_t(double(_base_step) * factor);
+}
+
+void Beeper::reset(uint64_t start, int level)
+{
+    std::fill(_acc.begin(), _acc.end(), 0);
+    _start = start;
+    _start_pos = 0;
+    _level = level;
+    _sum = LEVELS[level] * KERNEL_ONE;
+    _dc = _sum;
+}
+
+uint64_t Beeper::position(uint64_t when) const
+{
+    return _start_pos + (when - _start) * _step;
+}
+
+void Beeper::edge(uint64_t when, int level)
+{
+    int delta = LEVELS[level] - LEVELS[_level];
+    _level = level;
+    if (not delta)
+        return;
+    uint64_t pos = position(std::max(when, _start));
+    size_t index = size_t(pos >> 32);
+    if (index + TAPS > _acc.size())
+        return;                     // кадр много длиннее двух: теряем фронт
+    const int16_t *kernel = _kernel[(pos >> (32 - PHASE_BITS)) & (PHASES - 1)];
+    int32_t *acc = &_acc[index];
+    for (int k = 0; k < TAPS; k++)
+        acc[k] += delta * kernel[k];
+}
+
+void Beeper::end_frame(uint64_t end, std::vector<int16_t> &out)
+{
+    uint64_t pos = position(end);
+    size_t count = std::min(size_t(pos >> 32), _acc.size() - TAPS);
+
+    out.reserve(out.size() + count);
+    for (size_t i = 0; i < count; i++) {
+        _sum += _acc[i];
+        _dc += (_sum - _dc) >> DC_SHIFT;
+        int sample = (_sum - _dc) / KERNEL_ONE * 2;
+        out.push_back(int16_t(std::max(-32768, std::min(32767, sample))));
+    }
+
+    // Хвосты импульсов и фронты после end - в начало буфера
+    std::copy(_acc.begin() + long(count), _acc.end(), _acc.begin());
+    std::fill(_acc.end() - long(count), _acc.end(), 0);
+    _start = end;
+    _start_pos = pos - (uint64_t(count) << 32);
+}
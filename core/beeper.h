@@ -0,0 +1,60 @@
+#ifndef BEEPER_H
+#define BEEPER_H
+
+#include <cstdint>
+#include <vector>
+
+// Звук бипера из фронтов: вместо выборки уровня каждый такт каждый
+// фронт (смена EAR/MIC в порту FE) кладёт в буфер накопления
+// ограниченный по полосе импульс - windowed sinc с дробной фазой
+// (BLEP). Выходной сэмпл - интеграл буфера, то есть ступенька без
+// наложения частот. Цена - TAPS умножений на фронт и одно сложение
+// на сэмпл, от числа тактов не зависит.
+class Beeper
+{
+public:
+    static constexpr int TAPS = 16;         // длина импульса, сэмплов
+    static constexpr int PHASE_BITS = 5;
+    static constexpr int PHASES = 1 << PHASE_BITS;  // дробных положений фронта
+    static constexpr int KERNEL_ONE = 1 << 15;
+
+    // Уровни выхода по битам MIC (3) и EAR (4) порта FE
+    static constexpr int LEVELS[4] = { 0, 2048, 6144, 8192 };
+
+    Beeper(int sample_rate = 48000, uint32_t cpu_hz = 3500000);
+
+    // Частота вывода и такт CPU; буфер накопления очищается
+    void set_rate(int sample_rate, uint32_t cpu_hz);
+    int sample_rate() const { return _sample_rate; }
+    // Подстройка частоты вывода (AudioStream::rate_adjust) с начала
+    // следующего кадра; буфер не трогается
+    void set_adjust(double factor);
+
+    // Начать отсчёт с такта start на уровне level (0..3)
+    void reset(uint64_t start, int level = 0);
+
+    // Смена уровня в такте when (не раньше прошлой смены и начала кадра)
+    void edge(uint64_t when, int level);
+
+    // Кадр закончился в такте end: готовые сэмплы дописываются в out.
+    // Фронты чуть позже end (CPU останавливается на границе инструкции)
+    // досчитаются в следующем кадре
+    void end_frame(uint64_t end, std::vector<int16_t> &out);
+
+private:
+    uint64_t position(uint64_t when) const;
+
+    int _sample_rate { 0 };
+    uint64_t _base_step { 0 };          // сэмплов на такт, 32.32
+    uint64_t _step { 0 };               // он же с подстройкой
+    int16_t _kernel[PHASES][TAPS];
+
+    uint64_t _start { 0 };              // такт, с которого считается _start_pos
+    uint64_t _start_pos { 0 };          // его положение от _acc[0], 32.32
+    std::vector<int32_t> _acc;          // приращения уровня * KERNEL_ONE
+    int _level { 0 };
+    int32_t _sum { 0 };                 // интеграл _acc - уровень * KERNEL_ONE
+    int32_t _dc { 0 };                  // постоянная составляющая _sum
+};
+
+#endif // BEEPER_H
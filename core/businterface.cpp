@@ -0,0 +1,40 @@
+#include "businterface.h"
+
+void BusInterface::key_press(int row, int col)
+{
+    portfe.press_key(row, col);
+}
+
+void BusInterface::key_release(int row, int col)
+{
+    portfe.release_key(row, col);
+}
+
+void BusInterface::write_fe(uint32_t addr, uint8_t value)
+{
+    int border = portfe.border();
+    int speaker = portfe.speaker();
+    portfe.write8(addr, value);
+    if (portfe.border() != border)
+        _border_log.push_back({ now(), uint8_t(portfe.border()) });
+    if (portfe.speaker() != speaker)
+        _speaker_log.push_back({ now(), uint8_t(portfe.speaker()) });
+    if (_fe_hook)
+        _fe_hook();
+}
+
+void BusInterface::take_dirty(DirtyMap dirty)
+{
+    uint32_t *screen = _dirty[screen_index()];
+    for (int row = 0; row < SCREEN_ROWS; row++) {
+        dirty[row] = screen[row];
+        screen[row] = 0;
+    }
+}
+
+void BusInterface::invalidate_screen()
+{
+    for (DirtyMap &screen : _dirty)
+        for (uint32_t &row : screen)
+            row = ~0u;
+}
@@ -0,0 +1,170 @@
+#ifndef BUSINTERFACE_H
+#define BUSINTERFACE_H
+
+#include "romdevice.h"
+#include "ramdevice.h"
+#include "portfe.h"
+#include "port1f.h"
+#include "emulation/CPU/Z80.h"
+#include "machinetiming.h"
+#include <functional>
+#include <vector>
+
+class AY8912;
+
+class BusInterface
+{
+public:
+    static constexpr int PAGE_SHIFT = 14;
+    static constexpr uint32_t PAGE_SIZE = 1 << PAGE_SHIFT;
+    static constexpr uint32_t PAGE_MASK = PAGE_SIZE - 1;
+    static constexpr int PAGE_COUNT = 4;
+
+    // Экран в начале своего банка: 6144 байта точек и 768 атрибутов
+    static constexpr uint32_t SCREEN_PIXELS = 6144;
+    static constexpr uint32_t SCREEN_SIZE = 6912;
+    static constexpr int SCREEN_ROWS = 24;
+
+    // Карта грязных знакомест: бит x слова y - знакоместо (x, y)
+    using DirtyMap = uint32_t[SCREEN_ROWS];
+
+    BusInterface() = default;
+    virtual ~BusInterface() = default;
+
+    virtual uint8_t mem_read8(uint32_t addr) = 0;
+    virtual void mem_write8(uint32_t addr, uint8_t value) = 0;
+
+    virtual uint8_t io_read8(uint32_t addr) = 0;
+    virtual void io_write8(uint32_t addr, uint8_t value) = 0;
+
+    // Порт можно отдать INIR/OTIR целиком за один вызов инструкции:
+    // обращение к нему не переключает память (Z80.c, BULK_IO_SAFE)
+    virtual bool io_bulk_safe(uint32_t addr) const { Q_UNUSED(addr); return false; }
+
+    // Запуск CPU ядром, специализированным под эту шину (z80core.h)
+    virtual zusize run_cpu(Z80 *cpu, zusize cycles) = 0;
+
+    // Быстрый путь для CPU: адрес делится на 4 страницы по 16К,
+    // таблицы страниц перестраиваются только при записи в порт 7FFD.
+    uint8_t page_read8(uint16_t addr) const
+    { return _read_page[addr >> PAGE_SHIFT][addr & PAGE_MASK]; }
+    // Запись в экранный банк, меняющая байт, помечает его знакоместо
+    void page_write8(uint16_t addr, uint8_t value)
+    {
+        int n = addr >> PAGE_SHIFT;
+        uint32_t offset = addr & PAGE_MASK;
+        uint8_t *data = &_write_page[n][offset];
+        if (_dirty_page[n] and offset < SCREEN_SIZE and *data != value)
+            mark_dirty(_dirty_page[n], offset);
+        *data = value;
+    }
+    const uint8_t * read_page(int n) const { return _read_page[n]; }
+    uint8_t * write_page(int n) const { return _write_page[n]; }
+
+    int border() const { return portfe.border();}
+
+    // Смены цвета бордюра: такт от включения машины и новый цвет.
+    // Время берётся из часов set_clock(); лог разбирает и чистит Machine
+    struct BorderChange
+    {
+        uint64_t when;
+        uint8_t color;
+    };
+    std::vector<BorderChange> & border_log() { return _border_log; }
+
+    // Смены уровня на динамике (биты MIC и EAR порта FE) для Beeper,
+    // так же по тактам; разбирает и чистит Machine
+    struct SpeakerChange
+    {
+        uint64_t when;
+        uint8_t level;
+    };
+    std::vector<SpeakerChange> & speaker_log() { return _speaker_log; }
+    int speaker() const { return portfe.speaker(); }
+    // Выход MIC (бит 3 порта FE): запись ленты
+    bool tape_out() const { return portfe.tape_out(); }
+
+    // Вход EAR порта FE: уровень с магнитофона (TapeDeck)
+    void set_ear(bool level) { portfe.set_ear(level); }
+    bool ear() const { return portfe.ear(); }
+    // Вызывается после каждой записи в порт FE: по ней Machine узнаёт
+    // вход в LD-BYTES. Пустой - ловушек нет
+    void set_fe_hook(std::function<void ()> hook) { _fe_hook = std::move(hook); }
+    // Вызывается перед каждым чтением порта FE: ускорение загрузчиков
+    // (Machine) может сдвинуть в нём часы CPU
+    void set_ear_hook(std::function<void ()> hook) { _ear_hook = std::move(hook); }
+
+    // Часы машины: такт начала текущего z80_run и счётчик тактов внутри
+    // него (Z80::cycles актуален и в обратных вызовах портов)
+    void set_clock(const uint64_t *run_start, const zusize *run_cycles)
+    { _run_start = run_start; _run_cycles = run_cycles; }
+    uint64_t now() const
+    { return _run_start ? *_run_start + *_run_cycles : 0; }
+    int _color_pal { 1 };
+
+    virtual const uint8_t * framebuffer() const = 0;
+
+    // Отдаёт в dirty знакоместа показываемого экрана, изменённые с прошлого
+    // вызова, и очищает его карту. Переключение экрана (7FFD) сюда не
+    // попадает: рисующий сам сравнивает framebuffer() с прошлым
+    void take_dirty(DirtyMap dirty);
+    // Всё грязное: после записи в память в обход CPU
+    void invalidate_screen();
+
+    virtual const MachineTiming & timing() const = 0;
+    virtual const ROMDevice & rom_device() const = 0;
+    // Музыкальный сопроцессор, nullptr - его нет (48К)
+    virtual AY8912 * ay() { return nullptr; }
+
+    void key_press(int row, int col);
+    void key_release(int row, int col);
+
+    void kj_button_press(int btn)  { port1f.press_button(btn); }
+    void kj_button_release(int btn)  { port1f.release_button(btn); }
+    virtual void reset() {};
+
+protected:
+    virtual void map_pages() = 0;
+    // Какая из карт _dirty у показываемого экрана
+    virtual int screen_index() const { return 0; }
+    // Запись в порт FE с отметкой смены бордюра и динамика в логах
+    void write_fe(uint32_t addr, uint8_t value);
+    uint8_t read_fe(uint32_t addr)
+    {
+        if (_ear_hook)
+            _ear_hook();
+        return portfe.read8(addr);
+    }
+
+    // точки:    0 0 0 Y7 Y6 Y2 Y1 Y0 Y5 Y4 Y3 X4 X3 X2 X1 X0
+    // атрибуты: 0 0 0 1  1  0  Y7 Y6 Y5 Y4 Y3 X4 X3 X2 X1 X0
+    static void mark_dirty(uint32_t *dirty, uint32_t offset)
+    {
+        uint32_t row = offset < SCREEN_PIXELS
+                ? ((offset >> 8) & 0b11000) | ((offset >> 5) & 0b111)
+                : (offset - SCREEN_PIXELS) >> 5;
+        dirty[row] |= 1u << (offset & 31);
+    }
+
+    PortFE portfe;
+    Port1F port1f;
+
+    const uint8_t * _read_page[PAGE_COUNT] {};
+    uint8_t * _write_page[PAGE_COUNT] {};
+    uint8_t _rom_sink[PAGE_SIZE] {}; // сюда уходят записи в ПЗУ
+
+    // Карты грязных знакомест экранов (у 128К: банк 5 и банк 7) и карта
+    // для каждой страницы адресного пространства, nullptr - не экран
+    DirtyMap _dirty[2] {};
+    uint32_t * _dirty_page[PAGE_COUNT] {};
+
+    std::vector<BorderChange> _border_log;
+    std::vector<SpeakerChange> _speaker_log;
+    const uint64_t * _run_start { nullptr };
+    const zusize * _run_cycles { nullptr };
+    std::function<void ()> _fe_hook;
+    std::function<void ()> _ear_hook;
+
+};
+
+#endif // BUSINTERFACE_H
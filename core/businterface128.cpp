@@ -0,0 +1,73 @@
+#include "businterface128.h"
+#include "z80core.h"
+
+BusInterface128::BusInterface128(const QString &rom_file)
+    : rom(rom_file)
+{
+    map_pages();
+}
+
+// 0000-3FFF: ПЗУ (rom_page)
+// 4000-7FFF: банк 5
+// 8000-BFFF: банк 2
+// C000-FFFF: банк ram_page
+void BusInterface128::map_pages()
+{
+    _read_page[0] = rom.page(mapper.rom_page());
+    _write_page[0] = _rom_sink;
+    _read_page[1] = _write_page[1] = ram.page(5);
+    _read_page[2] = _write_page[2] = ram.page(2);
+    _read_page[3] = _write_page[3] = ram.page(mapper.ram_page());
+
+    // Экраны - банки 5 и 7, банк 5 виден в двух окнах сразу
+    _dirty_page[1] = _dirty[0];
+    _dirty_page[3] = mapper.ram_page() == 5 ? _dirty[0] :
+                     mapper.ram_page() == 7 ? _dirty[1] : nullptr;
+}
+
+uint8_t BusInterface128::mem_read8(uint32_t addr)
+{
+    return page_read8(addr);
+}
+
+void BusInterface128::mem_write8(uint32_t addr, uint8_t value)
+{
+    page_write8(addr, value);
+}
+
+uint8_t BusInterface128::io_read8(uint32_t addr)
+{
+    if ((addr & 1) == 0)
+       return read_fe(addr);
+    if ((addr & 0b1100'0000'0000'0010) == 0b1100'0000'0000'0000)
+        return psg.read8(addr);
+    if ((addr & 0b100000) == 0)
+        return port1f.read8(addr);
+    return 0xff;
+}
+
+void BusInterface128::io_write8(uint32_t addr, uint8_t value)
+{
+    if ((addr & 0b1000'0000'0000'0010) == 0) {
+        mapper.write8(addr, value);
+        map_pages();
+    }
+    // FFFD и BFFD; генератор сначала догоняет время записи
+    if ((addr & 0b1000'0000'0000'0010) == 0b1000'0000'0000'0000) {
+        psg.update(now());
+        psg.write8(addr, value);
+    }
+    if ((addr & 1) == 0)
+        write_fe(addr, value);
+}
+
+// Всё, кроме 7FFD: после записи в него опкод надо выбирать заново
+bool BusInterface128::io_bulk_safe(uint32_t addr) const
+{
+    return (addr & 0b1000'0000'0000'0010) != 0;
+}
+
+zusize BusInterface128::run_cpu(Z80 *cpu, zusize cycles)
+{
+    return Z80Core<BusInterface128>::run(cpu, cycles);
+}
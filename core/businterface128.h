@@ -0,0 +1,57 @@
+#ifndef BUSINTERFACE128_H
+#define BUSINTERFACE128_H
+
+#include "ay8912.h"
+#include "businterface.h"
+#include "port7ffd.h"
+
+class BusInterface128 : public BusInterface
+{
+public:
+#if defined (Q_OS_ANDROID)
+    static constexpr const char * DEFAULT_ROM = "assets:/rom/128.rom";
+#else
+    static constexpr const char * DEFAULT_ROM = "rom/128.rom";
+#endif
+
+    explicit BusInterface128(const QString &rom_file = DEFAULT_ROM);
+
+    virtual uint8_t mem_read8(uint32_t addr) override;
+    virtual void mem_write8(uint32_t addr, uint8_t value) override;
+
+    virtual uint8_t io_read8(uint32_t addr) override;
+    virtual void io_write8(uint32_t addr, uint8_t value) override;
+    virtual bool io_bulk_safe(uint32_t addr) const override;
+
+    virtual zusize run_cpu(Z80 *cpu, zusize cycles) override;
+
+
+    virtual const MachineTiming & timing() const override
+    {return TIMING_128K;}
+
+    virtual const ROMDevice & rom_device() const override
+    {return rom;}
+
+    virtual AY8912 * ay() override { return &psg; }
+
+    virtual const uint8_t * framebuffer() const override
+    {
+        return ram.getBuffer(0x4000 * mapper.vram_page());//fixME:128
+    }
+
+    virtual void reset() override { mapper.reset(); psg.reset(); map_pages(); }
+
+protected:
+    virtual void map_pages() override;
+    virtual int screen_index() const override
+    { return mapper.vram_page() == 7 ? 1 : 0; }
+
+    ROMDevice rom;
+    RAMDevice ram { 17 };
+    Port7FFD mapper;
+    AY8912 psg;
+
+
+};
+
+#endif // BUSINTERFACE128_H
@@ -0,0 +1,55 @@
+#include "businterface48.h"
+#include "z80core.h"
+
+BusInterface48::BusInterface48(const QString &rom_file)
+    : rom(rom_file)
+{
+    map_pages();
+}
+
+void BusInterface48::map_pages()
+{
+    _read_page[0] = rom.page(0);
+    _write_page[0] = _rom_sink;
+    for (int p = 1; p < PAGE_COUNT; p++) {
+        _read_page[p] = _write_page[p] = ram.page(p);
+        _dirty_page[p] = nullptr;
+    }
+    _dirty_page[1] = _dirty[0];
+}
+
+uint8_t BusInterface48::mem_read8(uint32_t addr)
+{
+    return page_read8(addr);
+}
+
+void BusInterface48::mem_write8(uint32_t addr, uint8_t value)
+{
+    page_write8(addr, value);
+}
+
+uint8_t BusInterface48::io_read8(uint32_t addr)
+{
+    if ((addr & 1) == 0)
+       return read_fe(addr);
+    if ((addr & 0b100000) == 0)
+        return port1f.read8(addr);
+    return 0xff;
+}
+
+void BusInterface48::io_write8(uint32_t addr, uint8_t value)
+{
+    if ((addr & 1) == 0)
+        write_fe(addr, value);
+}
+
+bool BusInterface48::io_bulk_safe(uint32_t addr) const
+{
+    Q_UNUSED(addr);
+    return true;
+}
+
+zusize BusInterface48::run_cpu(Z80 *cpu, zusize cycles)
+{
+    return Z80Core<BusInterface48>::run(cpu, cycles);
+}
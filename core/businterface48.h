@@ -5,27 +5,38 @@
 
 class BusInterface48 : public BusInterface
 {
-    Q_OBJECT
 public:
-    BusInterface48();
+#if defined (Q_OS_ANDROID)
+    static constexpr const char * DEFAULT_ROM = "assets:/rom/48.rom";
+#else
+    static constexpr const char * DEFAULT_ROM = "rom/48.rom";
+#endif
+
+    explicit BusInterface48(const QString &rom_file = DEFAULT_ROM);
 
     virtual uint8_t mem_read8(uint32_t addr) override;
     virtual void mem_write8(uint32_t addr, uint8_t value) override;
 
     virtual uint8_t io_read8(uint32_t addr) override;
     virtual void io_write8(uint32_t addr, uint8_t value) override;
+    virtual bool io_bulk_safe(uint32_t addr) const override;
+
+    virtual zusize run_cpu(Z80 *cpu, zusize cycles) override;
+
 
+    virtual const MachineTiming & timing() const override
+    {return TIMING_48K;}
+
+    virtual const ROMDevice & rom_device() const override
+    {return rom;}
 
     virtual const uint8_t * framebuffer() const override
     {return ram.getBuffer(16384);}
 
 protected:
-#if defined(WIN32)
-    ROMDevice rom {"rom/48.rom"};
-#endif
-#if defined (Q_OS_ANDROID)
-    ROMDevice rom {"assets:/rom/48.rom"};
-#endif
+    virtual void map_pages() override;
+
+    ROMDevice rom;
 
     RAMDevice ram { 16 };
 
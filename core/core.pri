@@ -0,0 +1,21 @@
+# Подключение libspeccy к приложению: include(<путь>/core/core.pri).
+# Библиотеку собирает core.pro в соседнем каталоге сборки.
+
+INCLUDEPATH +=\
+    $$PWD \
+    $$PWD/../3rdparty/Z/API \
+    $$PWD/../3rdparty/Z80/API
+
+DEPENDPATH += $$PWD
+
+DEFINES += \
+        CPU_Z80_STATIC
+
+SPECCY_LIB_DIR = $$shadowed($$PWD)
+win32:CONFIG(release, debug|release): SPECCY_LIB_DIR = $$SPECCY_LIB_DIR/release
+else:win32:CONFIG(debug, debug|release): SPECCY_LIB_DIR = $$SPECCY_LIB_DIR/debug
+
+LIBS += -L$$SPECCY_LIB_DIR -lspeccy
+
+win32:!win32-g++: PRE_TARGETDEPS += $$SPECCY_LIB_DIR/speccy.lib
+else: PRE_TARGETDEPS += $$SPECCY_LIB_DIR/libspeccy.a
@@ -0,0 +1,85 @@
+# libspeccy - ядро эмулятора: CPU, шина, устройства и Machine.
+# Без виджетов и цикла событий (QtCore нужен только для QFile
+# и assets:/ на Android). С ним собираются GUI (app), консольный
+# запуск и бенчмарки, см. core.pri.
+
+TEMPLATE = lib
+CONFIG += staticlib c++17
+QT = core
+
+TARGET = speccy
+
+SOURCES += \
+    audiostream.cpp \
+    ay8912.cpp \
+    beeper.cpp \
+    businterface.cpp \
+    businterface128.cpp \
+    businterface48.cpp \
+    framepacer.cpp \
+    inputqueue.cpp \
+    machine.cpp \
+    port1f.cpp \
+    port7ffd.cpp \
+    portfe.cpp \
+    ramdevice.cpp \
+    romdevice.cpp \
+    scheduler.cpp \
+    screendecoder.cpp \
+    tapedeck.cpp \
+    tapeimage.cpp \
+    taperecorder.cpp \
+    tapewriter.cpp \
+    tapimage.cpp \
+    tzximage.cpp \
+    ../3rdparty/Z80/sources/Z80.c \
+    z80core.cpp \
+    z80jit.cpp
+
+HEADERS += \
+    audioring.h \
+    audiostream.h \
+    ay8912.h \
+    beeper.h \
+    busdevice.h \
+    businterface.h \
+    businterface128.h \
+    businterface48.h \
+    frame.h \
+    framepacer.h \
+    framequeue.h \
+    inputqueue.h \
+    machine.h \
+    machinetiming.h \
+    port1f.h \
+    port7ffd.h \
+    portfe.h \
+    ramdevice.h \
+    ringqueue.h \
+    romdevice.h \
+    scheduler.h \
+    screendecoder.h \
+    tapedeck.h \
+    tapeimage.h \
+    taperecorder.h \
+    tapewriter.h \
+    tapimage.h \
+    tzximage.h \
+    ../3rdparty/Z80/API/emulation/CPU/Z80.h \
+    z80core.h \
+    z80jit.h
+
+INCLUDEPATH +=\
+    ../3rdparty/Z/API \
+    ../3rdparty/Z80/API
+
+DEFINES += \
+        CPU_Z80_STATIC
+
+# qmake CONFIG+=z80_threaded - цикл z80_run с диспетчеризацией через
+# computed goto (GCC/Clang), см. CPU_Z80_THREADED_DISPATCH в Z80.c
+z80_threaded: DEFINES += CPU_Z80_THREADED_DISPATCH
+
+# qmake CONFIG+=z80_jit - Machine по умолчанию исполняет горячий код
+# через кэш трансляции Z80Jit (z80jit.h), на x86-64 - в виде машинного кода
+z80_jit: DEFINES += Z80_JIT
@@ -0,0 +1,22 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <cstdint>
+#include "businterface.h"
+
+// Готовый кадр: всё, что нужно для вывода, без обращений к машине
+struct Frame
+{
+    static constexpr int MAX_LINES = 320;   // строк развёртки у Пентагона
+
+    uint64_t number { 0 };                  // Machine::frames() в конце кадра
+    uint8_t vram[BusInterface::SCREEN_SIZE] {};
+    BusInterface::DirtyMap dirty {};        // изменилось с кадра number - 1
+    uint8_t border[MAX_LINES] {};           // цвет бордюра в начале строки
+    int lines { 0 };
+    int screen_line { 0 };                  // строка начала области точек
+    bool flash { false };                   // фаза мигания
+    int palette { 1 };                      // BusInterface::_color_pal
+};
+
+#endif // FRAME_H
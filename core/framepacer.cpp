@@ -0,0 +1,92 @@
+#include "framepacer.h"
+#include <algorithm>
+#include <thread>
+
+constexpr std::chrono::microseconds FramePacer::SPIN;
+
+FramePacer::FramePacer(double rate)
+    : _period(1.0 / rate)
+{
+    restart();
+}
+
+void FramePacer::set_rate(double rate)
+{
+    _period = std::chrono::duration<double>(1.0 / rate);
+    restart();
+}
+
+void FramePacer::restart()
+{
+    _start = Clock::now();
+    _frame = 0;
+}
+
+void FramePacer::wait()
+{
+    _frame++;
+    Clock::time_point deadline = _start
+            + std::chrono::duration_cast<Clock::duration>(_period * double(_frame));
+    Clock::time_point now = Clock::now();
+
+    if (now - deadline > _period * double(MAX_LAG)) {
+        _resyncs++;
+        record(now - deadline);
+        _start = now;
+        _frame = 0;
+        return;
+    }
+
+    if (deadline - now > SPIN)
+        std::this_thread::sleep_until(deadline - SPIN);
+    while ((now = Clock::now()) < deadline)
+        std::this_thread::yield();
+    record(now - deadline);
+}
+
+void FramePacer::record(Clock::duration late)
+{
+    int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(late).count();
+    _buckets[std::min<int64_t>(us / BUCKET_US, BUCKETS - 1)]++;
+    _frames++;
+    if (us > _max_late_us)
+        _max_late_us = us;
+}
+
+int FramePacer::percentile_us(double p) const
+{
+    uint64_t total = _frames;
+    uint64_t need = uint64_t(p * double(total));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS - 1; i++) {
+        seen += _buckets[i];
+        if (seen >= need)
+            return (i + 1) * BUCKET_US;
+    }
+    return int(_max_late_us);
+}
+
+void FramePacer::clear_stats()
+{
+    for (std::atomic<uint32_t> &bucket : _buckets)
+        bucket = 0;
+    _frames = 0;
+    _resyncs = 0;
+    _max_late_us = 0;
+}
+
+QString FramePacer::summary() const
+{
+    QString text = QString("%1 frames at %2 Hz, late p50 < %3 us, p99 < %4 us, max %5 us, %6 resyncs\n")
+            .arg(frames()).arg(rate(), 0, 'f', 3)
+            .arg(percentile_us(0.5)).arg(percentile_us(0.99))
+            .arg(max_late_us()).arg(resyncs());
+    for (int i = 0; i < BUCKETS; i++) {
+        if (not _buckets[i])
+            continue;
+        QString range = i == BUCKETS - 1 ? QString(">= %1 us").arg(i * BUCKET_US)
+                                         : QString("%1-%2 us").arg(i * BUCKET_US).arg((i + 1) * BUCKET_US);
+        text += QString("  %1 %2\n").arg(range, 14).arg(bucket(i));
+    }
+    return text;
+}
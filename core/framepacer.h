@@ -0,0 +1,65 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Темп кадров по монотонным часам (steady_clock). Срок кадра n -
+// начало отсчёта + n * период, а не "прошлый кадр + период", поэтому
+// ошибки сна и опоздания не накапливаются. Ожидание: сон до срока
+// без SPIN, остаток - активно, на yield(). Если отстали больше чем на
+// MAX_LAG кадров (отладчик, перегрузка), не догоняем, а начинаем
+// отсчёт заново.
+//
+// Опоздание начала каждого кадра относительно срока копится в
+// гистограмме; её можно читать из любого потока.
+class FramePacer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int BUCKETS = 41;          // последняя - всё, что дальше
+    static constexpr int BUCKET_US = 250;
+    static constexpr int MAX_LAG = 5;
+    static constexpr std::chrono::microseconds SPIN { 1500 };
+
+    explicit FramePacer(double rate = 50.0);
+
+    // Кадров в секунду; отсчёт начинается заново
+    void set_rate(double rate);
+    double rate() const { return 1.0 / _period.count(); }
+    Clock::duration period() const
+    { return std::chrono::duration_cast<Clock::duration>(_period); }
+    void restart();
+
+    // Ждёт срока следующего кадра
+    void wait();
+
+    // Кадров с опозданием [i, i + 1) * BUCKET_US мкс
+    uint32_t bucket(int i) const { return _buckets[i]; }
+    uint64_t frames() const { return _frames; }
+    uint64_t resyncs() const { return _resyncs; }
+    int64_t max_late_us() const { return _max_late_us; }
+    // Верхняя граница опоздания у доли p кадров (0..1), мкс
+    int percentile_us(double p) const;
+    void clear_stats();
+
+    // Сводка и ненулевые корзины гистограммы, по строке на корзину
+    QString summary() const;
+
+private:
+    void record(Clock::duration late);
+
+    std::chrono::duration<double> _period;
+    Clock::time_point _start;
+    uint64_t _frame { 0 };                      // номер кадра от _start
+
+    std::atomic<uint32_t> _buckets[BUCKETS] {};
+    std::atomic<uint64_t> _frames { 0 };
+    std::atomic<uint64_t> _resyncs { 0 };
+    std::atomic<int64_t> _max_late_us { 0 };
+};
+
+#endif // FRAMEPACER_H
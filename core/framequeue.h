@@ -0,0 +1,34 @@
+#ifndef FRAMEQUEUE_H
+#define FRAMEQUEUE_H
+
+#include <Z/classes/buffering/TripleBuffer.hpp>
+#include "frame.h"
+
+// Кадры от эмуляции к выводу через тройной буфер Z (TripleBuffer.hpp).
+// Эмуляция пишет в свой кадр и публикует его, никогда не дожидаясь
+// вывода; вывод забирает самый свежий из опубликованных, пропуская
+// непоказанные. Кадр, который читает вывод, до следующего consume()
+// не перезаписывается, поэтому разорванных кадров не бывает.
+// Один поток пишет, один читает.
+class FrameQueue
+{
+public:
+    FrameQueue() { _buffer.initialize(_frames, sizeof(Frame)); }
+    FrameQueue(const FrameQueue &) = delete;
+    FrameQueue & operator=(const FrameQueue &) = delete;
+
+    // Сторона эмуляции: заполнить production_frame() и опубликовать
+    Frame & production_frame()
+    { return *static_cast<Frame *>(_buffer.production_buffer()); }
+    void publish() { _buffer.produce(); }
+
+    // Сторона вывода: новый кадр или nullptr, если нового не было
+    const Frame * consume()
+    { return static_cast<const Frame *>(_buffer.consume()); }
+
+private:
+    Frame _frames[3];
+    Zeta::TripleBuffer _buffer;
+};
+
+#endif // FRAMEQUEUE_H
@@ -0,0 +1,76 @@
+#include "inputqueue.h"
+#include <algorithm>
+#include "machine.h"
+
+bool InputQueue::push(InputEvent::Type type, int a, int b)
+{
+    InputEvent event;
+    event.type = type;
+    event.a = uint8_t(a);
+    event.b = uint8_t(b);
+    event.stamp = Clock::now();
+    if (_ring.push(event))
+        return true;
+    _dropped++;
+    return false;
+}
+
+int InputQueue::schedule(Machine &machine, Clock::time_point now, Clock::duration period)
+{
+    // Прошлый период длиннее period (первый кадр, пересинхронизация
+    // FramePacer): более старые события - в начало кадра
+    Clock::time_point start = std::max(_period_start, now - period);
+    _period_start = now;
+
+    const uint32_t frame_cycles = machine.scheduler().timing().frame_cycles;
+    const uint64_t frame = machine.next_frame();
+    int count = 0;
+
+    InputEvent event;
+    for (;;) {
+        if (_has_pending) {
+            event = _pending;
+            _has_pending = false;
+        } else if (not _ring.pop(event)) {
+            break;
+        }
+        // Пришло уже после now - в следующий кадр
+        if (event.stamp >= now) {
+            _pending = event;
+            _has_pending = true;
+            break;
+        }
+
+        Clock::duration offset = std::max(event.stamp - start, Clock::duration::zero());
+        uint64_t cycle = uint64_t(double(offset.count()) / double(period.count()) * frame_cycles);
+        cycle = std::min<uint64_t>(cycle, frame_cycles - 1);
+
+        Machine *target = &machine;
+        machine.scheduler().schedule(frame + cycle, [target, event](uint64_t) {
+            BusInterface *bus = target->bus();
+            switch (event.type) {
+            case InputEvent::KEY_PRESS:   bus->key_press(event.a, event.b); break;
+            case InputEvent::KEY_RELEASE: bus->key_release(event.a, event.b); break;
+            case InputEvent::KJ_PRESS:    bus->kj_button_press(event.a); break;
+            case InputEvent::KJ_RELEASE:  bus->kj_button_release(event.a); break;
+            }
+        });
+
+        int64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                    now + offset - event.stamp).count();
+        _events++;
+        _latency_us_sum += latency;
+        if (latency > _max_latency_us)
+            _max_latency_us = latency;
+        count++;
+    }
+    return count;
+}
+
+void InputQueue::clear_stats()
+{
+    _events = 0;
+    _dropped = 0;
+    _max_latency_us = 0;
+    _latency_us_sum = 0;
+}
@@ -0,0 +1,67 @@
+#ifndef INPUTQUEUE_H
+#define INPUTQUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "ringqueue.h"
+
+class Machine;
+
+struct InputEvent
+{
+    enum Type : uint8_t {
+        KEY_PRESS,      // a - ряд, b - столбец
+        KEY_RELEASE,
+        KJ_PRESS,       // a - кнопка Port1F::KJ_*
+        KJ_RELEASE
+    };
+    Type type { KEY_PRESS };
+    uint8_t a { 0 };
+    uint8_t b { 0 };
+    std::chrono::steady_clock::time_point stamp {};    // ставит push()
+};
+
+// Клавиши и джойстик от GUI к потоку эмуляции. Событие получает метку
+// времени хоста при push(), а поток эмуляции в начале кадра раскладывает
+// всё пришедшее за прошлый период по тактам нового кадра: пришедшее
+// через треть периода нажимается через треть кадра. Задержка ввода
+// поэтому постоянна (один период кадра) и не зависит от того, в какой
+// момент кадра пришло событие; матрицу клавиш трогает только поток
+// эмуляции. Один поток пишет, один читает.
+class InputQueue
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int SIZE = 256;
+
+    // Из GUI. false - очередь полна, событие потеряно
+    bool push(InputEvent::Type type, int a, int b = 0);
+
+    // Из потока эмуляции сразу после начала периода кадра (now):
+    // события с меткой до now ставятся в планировщик machine на такты
+    // следующего кадра. Возвращает число событий
+    int schedule(Machine &machine, Clock::time_point now, Clock::duration period);
+
+    // Задержка от push() до такта применения, в пересчёте на время хоста
+    uint64_t events() const { return _events; }
+    uint64_t dropped() const { return _dropped; }
+    int64_t max_latency_us() const { return _max_latency_us; }
+    int64_t mean_latency_us() const
+    { return _events ? _latency_us_sum / int64_t(_events) : 0; }
+    void clear_stats();
+
+private:
+    RingQueue<InputEvent, SIZE> _ring;
+    InputEvent _pending;                // прочитано, но моложе now
+    bool _has_pending { false };
+    Clock::time_point _period_start {};  // начало прошлого периода
+
+    std::atomic<uint64_t> _events { 0 };
+    std::atomic<uint64_t> _dropped { 0 };
+    std::atomic<int64_t> _max_latency_us { 0 };
+    std::atomic<int64_t> _latency_us_sum { 0 };
+};
+
+#endif // INPUTQUEUE_H
@@ -0,0 +1,844 @@
+#include "machine.h"
+#include <QFile>
+#include <QByteArray>
+#include <algorithm>
+#include <cstring>
+
+#include "ay8912.h"
+#include "businterface48.h"
+#include "businterface128.h"
+
+static constexpr uint32_t SCREEN_ADDR = 16384;
+static constexpr int SCREEN_SIZE = 6912;
+static constexpr int RAM48_SIZE = 49152;
+
+// LD-BYTES ПЗУ 48К (у 128К - ПЗУ 1, туда уходит и загрузка из меню):
+// INC D, EX AF,AF', DEC D, DI, LD A,0F, OUT (FE),A. Запись в FE с PC
+// за этим OUT - вход в подпрограмму; дальше она только ждёт фронтов
+// в LD-EDGE до конца LD-EDGE-1. Выход - через SA/LD-RET
+static constexpr uint16_t LD_BYTES = 0x0556;
+static constexpr uint16_t LD_BYTES_OUT_NEXT = 0x055E;
+static constexpr uint16_t LD_EDGE_END = 0x0604;
+static constexpr uint16_t SA_LD_RET = 0x053F;
+static const uint8_t LD_BYTES_CODE[] = { 0x14, 0x08, 0x15, 0xF3, 0x3E, 0x0F, 0xD3, 0xFE };
+
+// SA-BYTES: LD HL,SA/LD-RET, PUSH HL, LD HL,пилот, ... EX AF,AF',
+// INC DE, DEC IX, DI, LD A,02, LD B,A, DJNZ $, OUT (FE),A. Запись в FE
+// с PC за этим OUT и HL, равным числу импульсов пилота, - первый импульс
+// пилота. Подпрограмма кончается перед SA/LD-RET
+static constexpr uint16_t SA_BYTES = 0x04C2;
+static constexpr uint16_t SA_BYTES_CODE_ADDR = 0x04D0;
+static constexpr uint16_t SA_LEADER_OUT_NEXT = 0x04DC;
+static constexpr uint16_t SA_HEADER_PILOT = 0x1F80;
+static constexpr uint16_t SA_DATA_PILOT = 0x0C98;
+static const uint8_t SA_BYTES_CODE[] = { 0x08, 0x13, 0xDD, 0x2B, 0xF3, 0x3E, 0x02, 0x47, 0x10, 0xFE, 0xD3, 0xFE };
+
+// Флаги логической операции (AND без H, OR, XOR): S, Z, P/V - чётность,
+// недокументированные биты 3 и 5 из результата
+static uint8_t logic_flags(uint8_t value)
+{
+    uint8_t bits = value;
+    bits ^= bits >> 4;
+    bits ^= bits >> 2;
+    bits ^= bits >> 1;
+    return (value & 0xA8) | (value == 0 ? 0x40 : 0) | ((bits & 1) ? 0 : 0x04);
+}
+
+static uint8_t s_mem_read(void *context, uint16_t address)
+{
+    BusInterface * bi =reinterpret_cast<BusInterface*>(context);
+    return bi->page_read8(address);
+}
+
+static void s_mem_write(void *context, uint16_t address, uint8_t value)
+{
+    BusInterface * bi =reinterpret_cast<BusInterface*>(context);
+    bi->page_write8(address, value);
+}
+
+static uint8_t s_port_read(void *context, uint16_t address)
+{
+    BusInterface * bi =reinterpret_cast<BusInterface*>(context);
+    return bi->io_read8(address);
+}
+
+static void s_port_write(void *context, uint16_t address, uint8_t value)
+{
+    BusInterface * bi =reinterpret_cast<BusInterface*>(context);
+    bi->io_write8(address, value);
+}
+
+static uint32_t s_int_data(void *context)
+{
+    Q_UNUSED(context);
+    return 0xC3000000; // JP #0
+}
+
+// Ядро сообщает только о входе в HALT и выходе из него; сами такты
+// простоя оно пропускает до конца вызова (CPU_Z80_HALT_SKIP)
+static void s_halt(void *context, uint8_t state)
+{
+    Q_UNUSED(context);
+    Q_UNUSED(state);
+}
+
+Machine::Machine(Model model, const QString &rom_file)
+{
+#ifdef Z80_JIT
+    _use_jit = true;
+#endif
+    _cpu.read = s_mem_read;
+    _cpu.write = s_mem_write;
+    _cpu.in = s_port_read;
+    _cpu.out = s_port_write;
+    _cpu.int_data = s_int_data;
+    _cpu.halt = s_halt;
+
+    set_model(model, rom_file);
+    _bus->io_write8(0xfe, 1);
+}
+
+bool Machine::set_model(Model model, const QString &rom_file)
+{
+    _error.clear();
+    _jit.reset();
+    if (model == MODEL_48K)
+        _bus.reset(rom_file.isEmpty() ? new BusInterface48()
+                                      : new BusInterface48(rom_file));
+    else
+        _bus.reset(rom_file.isEmpty() ? new BusInterface128()
+                                      : new BusInterface128(rom_file));
+    _model = model;
+    _tape.set_48k(model == MODEL_48K);
+    _cpu.context = _bus.get();
+    _bus->set_clock(&_run_start, &_cpu.cycles);
+    install_tape_hooks();
+    _captured_vram = nullptr;
+    set_jit(_use_jit);
+    reset();
+
+    const ROMDevice &rom = _bus->rom_device();
+    if (not rom.loaded())
+        return fail(QString("Can't load a ROM file: ") + rom.filename());
+    return true;
+}
+
+void Machine::set_jit(bool enabled)
+{
+    _use_jit = enabled;
+    _jit.reset(enabled ? new Z80Jit(_bus.get()) : nullptr);
+}
+
+void Machine::reset()
+{
+    z80_reset(&_cpu);
+    _bus->reset();
+    if (_jit) _jit->flush();
+    start_frames();
+}
+
+void Machine::nmi()
+{
+    z80_nmi(&_cpu);
+}
+
+void Machine::run_frame()
+{
+    // Кадр начинается с INT, длина кадра своя у каждой модели
+    _next_frame += _scheduler.timing().frame_cycles;
+    _scheduler.run_until(_next_frame);
+    _frames++;
+    end_frame();
+}
+
+// Лог смен бордюра за кадр -> цвет в начале каждой строки развёртки
+void Machine::end_frame()
+{
+    const MachineTiming &timing = _scheduler.timing();
+    uint64_t start = _next_frame - timing.frame_cycles;
+    int lines = std::min(int(timing.frame_cycles / timing.line_cycles), Frame::MAX_LINES);
+    std::vector<BusInterface::BorderChange> &log = _bus->border_log();
+
+    auto change = log.begin();
+    for (int line = 0; line < lines; line++) {
+        uint64_t at = start + uint64_t(line) * timing.line_cycles;
+        while (change != log.end() and change->when <= at)
+            _border = change++->color;
+        _border_lines[line] = _border;
+    }
+    // Смены после последней строки - к следующему кадру
+    if (not log.empty())
+        _border = log.back().color;
+    log.clear();
+
+    _audio.clear();
+    for (const BusInterface::SpeakerChange &change : _bus->speaker_log())
+        _beeper.edge(change.when, change.level);
+    _bus->speaker_log().clear();
+    _beeper.end_frame(_next_frame, _audio);
+    if (AY8912 *ay = _bus->ay())
+        ay->end_frame(_next_frame, _audio.data(), int(_audio.size()));
+    _recorder.update(_next_frame);
+}
+
+void Machine::set_rate_adjust(double factor)
+{
+    _beeper.set_adjust(factor);
+    if (AY8912 *ay = _bus->ay())
+        ay->set_adjust(factor);
+}
+
+void Machine::set_sample_rate(int rate)
+{
+    const MachineTiming &timing = _scheduler.timing();
+    _beeper.set_rate(rate, timing.cpu_hz);
+    _beeper.reset(_next_frame, _bus->speaker());
+    if (AY8912 *ay = _bus->ay())
+        ay->set_clock(timing.cpu_hz, timing.ay_hz, rate, _next_frame);
+}
+
+void Machine::capture_frame(Frame &frame)
+{
+    const MachineTiming &timing = _scheduler.timing();
+    const uint8_t *vram = _bus->framebuffer();
+
+    frame.number = _frames;
+    std::memcpy(frame.vram, vram, sizeof(frame.vram));
+    _bus->take_dirty(frame.dirty);
+    // Переключился показываемый экран (7FFD) - изменилось всё
+    if (vram != _captured_vram) {
+        _captured_vram = vram;
+        std::fill(std::begin(frame.dirty), std::end(frame.dirty), ~0u);
+    }
+    frame.lines = std::min(int(timing.frame_cycles / timing.line_cycles), Frame::MAX_LINES);
+    frame.screen_line = int(timing.screen_line);
+    std::memcpy(frame.border, _border_lines, sizeof(frame.border));
+    frame.flash = _frames & 16;     // мигание - раз в 16 кадров
+    frame.palette = _bus->_color_pal;
+}
+
+zusize Machine::run_cpu(zusize cycles)
+{
+    _run_start = _scheduler.now();
+    if (_jit)
+        return _jit->run(&_cpu, cycles);
+    return _bus->run_cpu(&_cpu, cycles);
+}
+
+void Machine::start_frames()
+{
+    z80_int(&_cpu, 0);
+    _scheduler.clear();
+    _scheduler.set_timing(_bus->timing());
+    _next_frame = 0;
+    _frames = 0;
+    _loading_until = 0;
+    _run_start = 0;
+    _bus->border_log().clear();
+    _border = uint8_t(_bus->border());
+    _bus->speaker_log().clear();
+    _beeper.set_rate(_beeper.sample_rate(), _bus->timing().cpu_hz);
+    _beeper.reset(0, _bus->speaker());
+    if (AY8912 *ay = _bus->ay())
+        ay->set_clock(_bus->timing().cpu_hz, _bus->timing().ay_hz, _beeper.sample_rate(), 0);
+    schedule_frame(0);
+    _load_trap.pending = false;
+    _save_trap.pending = false;
+    _tape.restart();
+    _recorder.restart(_bus->timing().cpu_hz);
+}
+
+void Machine::schedule_frame(uint64_t when)
+{
+    _scheduler.schedule(when, [this](uint64_t start) {
+        z80_int(&_cpu, 1);
+        _scheduler.schedule(start + _scheduler.timing().int_cycles, [this](uint64_t) {
+            z80_int(&_cpu, 0);
+        });
+        schedule_frame(start + _scheduler.timing().frame_cycles);
+    });
+}
+
+// Запись в память в обход CPU: транслированный код надо сбросить
+void Machine::write_memory(uint32_t address, const uint8_t *data, int size)
+{
+    for (int off = 0; off < size; off++)
+        _bus->mem_write8(address + off, data[off]);
+    _bus->invalidate_screen();
+    if (_jit) _jit->flush();
+}
+
+bool Machine::fail(const QString &error)
+{
+    _error = error;
+    return false;
+}
+
+#pragma pack(push, 1)
+struct SNAHeader
+{
+    uint8_t I;
+    uint16_t HL_, DE_,
+             BC_, AF_;
+    uint16_t HL, DE, BC , IY, IX;
+    uint8_t IFF2;
+    uint8_t R;
+    uint16_t AF, SP;
+    uint8_t IM;
+    uint8_t BRD;
+};
+#pragma pack(pop)
+
+bool Machine::load_sna(const QString &filename)
+{
+    QFile sna(filename);
+    if (not sna.open(QIODevice::ReadOnly))
+        return fail(QString("Can't open a snapshot: ") + filename);
+
+    QByteArray buffer = sna.readAll();
+    if (buffer.size() < int(sizeof(SNAHeader)) + RAM48_SIZE)
+        return fail(QString("Not a 48K .sna snapshot: ") + filename);
+
+    const SNAHeader * sna_hdr = reinterpret_cast<const SNAHeader *>(buffer.constData());
+    const uint8_t * sna_memory = reinterpret_cast<const uint8_t *>(buffer.constData()) +
+                                 sizeof(SNAHeader);
+    z80_reset(&_cpu);
+    _cpu.state.i = sna_hdr->I;
+    _cpu.state.hl_.value_uint16 = sna_hdr->HL_;
+    _cpu.state.de_.value_uint16 = sna_hdr->DE_;
+    _cpu.state.bc_.value_uint16 = sna_hdr->BC_;
+    _cpu.state.af_.value_uint16 = sna_hdr->AF_;
+    _cpu.state.hl.value_uint16  = sna_hdr->HL;
+    _cpu.state.de.value_uint16  = sna_hdr->DE;
+    _cpu.state.bc.value_uint16  = sna_hdr->BC;
+    _cpu.state.iy.value_uint16  = sna_hdr->IY;
+    _cpu.state.ix.value_uint16  = sna_hdr->IX;
+    _cpu.state.internal.iff1    =
+    _cpu.state.internal.iff2    = (sna_hdr->IFF2 >> 2) & 1;
+    _cpu.state.r                = sna_hdr->R;
+    _cpu.state.af.value_uint16  = sna_hdr->AF;
+    _cpu.state.sp               = sna_hdr->SP;
+    _cpu.state.internal.im      = sna_hdr->IM & 0x03;
+    _bus->io_write8(0xfe, sna_hdr->BRD);
+    write_memory(SCREEN_ADDR, sna_memory, RAM48_SIZE);
+
+    // PC лежит на стеке: снапшот снят внутри NMI, выходим как по RETN
+    _cpu.state.pc = uint16_t(_bus->mem_read8(_cpu.state.sp) |
+                             (_bus->mem_read8(uint16_t(_cpu.state.sp + 1)) << 8));
+    _cpu.state.sp += 2;
+    return true;
+}
+
+#pragma pack(push, 1)
+struct Z80Header
+{
+    uint16_t AF;
+    uint16_t BC;
+    uint16_t HL;
+    uint16_t PC;
+    uint16_t SP;
+    uint8_t I, R;
+    uint8_t BDR;
+    uint16_t DE;
+    uint16_t BC_;
+    uint16_t DE_;
+    uint16_t HL_;
+    uint16_t AF_;
+    uint16_t IY;
+    uint16_t IX;
+    uint8_t IFF1;
+    uint8_t IFF2;
+    uint8_t IM;
+};
+#pragma pack(pop)
+
+bool Machine::load_z80(const QString &filename)
+{
+    QFile z80(filename);
+    if (not z80.open(QIODevice::ReadOnly))
+        return fail(QString("Can't open a snapshot: ") + filename);
+
+    QByteArray buffer = z80.readAll();
+    if (buffer.size() < int(sizeof(Z80Header)))
+        return fail(QString("Not a .z80 snapshot: ") + filename);
+
+    Z80Header * z80_hdr = reinterpret_cast<Z80Header *>(buffer.data());
+    uint8_t * z80_memory = reinterpret_cast<uint8_t *>(buffer.data()) + sizeof(Z80Header);
+
+    // PC == 0 - версии 2 и 3 с дополнительным заголовком и страницами
+    if (z80_hdr->PC == 0)
+        return fail(QString("Only version 1 .z80 snapshots are supported: ") + filename);
+
+    if (z80_hdr->BDR == 0xff) z80_hdr->BDR =0x01;
+    z80_reset(&_cpu);
+    _cpu.state.af.value_uint16 = z80_hdr->AF;
+    _cpu.state.bc.value_uint16 = z80_hdr->BC;
+    _cpu.state.hl.value_uint16 = z80_hdr->HL;
+    _cpu.state.pc = z80_hdr->PC;
+    _cpu.state.sp = z80_hdr->SP;
+    _cpu.state.i = z80_hdr->I;
+    _cpu.state.r = (z80_hdr->R &0x7f) | ((z80_hdr->BDR & 0x01) << 7);
+    _cpu.state.de.value_uint16 = z80_hdr->DE;
+    _cpu.state.bc_.value_uint16 = z80_hdr->BC_;
+    _cpu.state.de_.value_uint16 = z80_hdr->DE_;
+    _cpu.state.hl_.value_uint16 = z80_hdr->HL_;
+    _cpu.state.af_.value_uint16 = z80_hdr->AF_;
+    _cpu.state.iy.value_uint16 = z80_hdr->IY;
+    _cpu.state.ix.value_uint16 = z80_hdr->IX;
+    _cpu.state.internal.iff1 = z80_hdr->IFF1;
+    _cpu.state.internal.iff2 = z80_hdr->IFF2;
+    _cpu.state.internal.im = z80_hdr->IM & 0x03;
+    _bus->io_write8(0xfe, (z80_hdr->BDR >> 1) & 0x07);
+
+    int count = buffer.size() - sizeof(Z80Header);
+    if ( z80_hdr->BDR & 0x20)
+    {
+        QByteArray data;
+        int state = 0;
+        uint8_t *ptr = z80_memory;
+        unsigned reps = 0;
+
+        while (count--) {
+            uint8_t byte = *(ptr++);
+            if (state == 0 and byte == 0xed) { state = 1; continue; }
+            if (state == 0) { data.append(byte); continue; }
+            if (state == 1 and byte == 0xed) { state = 2; continue; }
+            if (state == 1) { data.append(0xed); data.append(byte); state = 0; continue; }
+            if (state == 2 and byte == 0x00) { break; }
+            if (state == 2) { reps = byte; state = 3; continue; }
+            while (reps--) data.append(byte);
+            state = 0;
+        }
+        write_memory(SCREEN_ADDR, reinterpret_cast<const uint8_t *>(data.constData()),
+                     std::min(data.size(), RAM48_SIZE));
+    }
+    else
+    {
+        write_memory(SCREEN_ADDR, z80_memory, std::min(count, RAM48_SIZE));
+    }
+    return true;
+}
+
+bool Machine::save_z80(const QString &filename)
+{
+    QFile z80_file(filename);
+    if (not z80_file.open(QIODevice::WriteOnly))
+        return fail(QString("Can't write a snapshot: ") + filename);
+
+    Z80Header header;
+    header.AF = _cpu.state.af.value_uint16;
+    header.BC = _cpu.state.bc.value_uint16;
+    header.HL = _cpu.state.hl.value_uint16;
+    header.PC = _cpu.state.pc;
+    header.SP = _cpu.state.sp;
+    header.I = _cpu.state.i;
+    header.R = (_cpu.state.r &0x7f);
+    header.BDR = (_bus->border() << 1);
+    header.DE = _cpu.state.de.value_uint16;
+    header.BC_ = _cpu.state.bc_.value_uint16;
+    header.DE_ = _cpu.state.de_.value_uint16;
+    header.HL_ = _cpu.state.hl_.value_uint16;
+    header.AF_ = _cpu.state.af_.value_uint16;
+    header.IY = _cpu.state.iy.value_uint16;
+    header.IX = _cpu.state.ix.value_uint16;
+    header.IFF1 = _cpu.state.internal.iff1;
+    header.IFF2 = _cpu.state.internal.iff2;
+    header.IM = (_cpu.state.internal.im & 0x03);
+    z80_file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    QByteArray buffer(RAM48_SIZE, 0);
+    for (int off = 0; off < RAM48_SIZE; off++)
+        buffer[off] = _bus->mem_read8(SCREEN_ADDR + off);
+    z80_file.write(buffer);
+    return true;
+}
+
+bool Machine::load_tape(const QString &filename)
+{
+    if (not _tape.open(filename))
+        return fail(_tape.error());
+    return true;
+}
+
+void Machine::set_tape_traps(bool enabled)
+{
+    _tape_traps = enabled;
+    install_tape_hooks();
+}
+
+void Machine::set_loader_acceleration(bool enabled)
+{
+    _accelerate_loaders = enabled;
+    install_tape_hooks();
+}
+
+bool Machine::record_tape(const QString &filename)
+{
+    bool ok = _recorder.open(filename, _scheduler.timing().cpu_hz);
+    install_tape_hooks();
+    return ok or fail(_recorder.error());
+}
+
+bool Machine::stop_recording()
+{
+    bool ok = _recorder.close();
+    install_tape_hooks();
+    return ok or fail(_recorder.error());
+}
+
+void Machine::install_tape_hooks()
+{
+    if (_tape_traps or _recorder.recording())
+        _bus->set_fe_hook([this] { fe_written(); });
+    else
+        _bus->set_fe_hook(nullptr);
+    _bus->set_ear_hook([this] { ear_read(); });
+    _edge_loop = EdgeLoop();
+    _mic = _bus->tape_out();
+}
+
+// Запись в FE: входы в LD-BYTES и SA-BYTES и фронты MIC для записи ленты
+void Machine::fe_written()
+{
+    if (_recorder.recording()) {
+        if (_tape_traps)
+            sa_bytes_entered();
+        bool mic = _bus->tape_out();
+        if (mic != _mic) {
+            _mic = mic;
+            // Пилот, который SA-BYTES выдал до срабатывания ловушки, не пишется
+            if (not _save_trap.pending)
+                _recorder.edge(_bus->now(), mic);
+        }
+    }
+    if (_tape_traps)
+        ld_bytes_entered();
+}
+
+bool Machine::code_mapped(uint16_t address, const uint8_t *code, size_t size) const
+{
+    for (size_t i = 0; i < size; i++)
+        if (_bus->page_read8(uint16_t(address + i)) != code[i])
+            return false;
+    return true;
+}
+
+// Из обратного вызова порта регистры не трогаются: срабатывание -
+// событием сразу после текущего прогона CPU, пока LD-BYTES ждёт пилот
+void Machine::ld_bytes_entered()
+{
+    if (_cpu.state.pc != LD_BYTES_OUT_NEXT or _load_trap.pending
+        or not _tape.loaded() or not code_mapped(LD_BYTES, LD_BYTES_CODE, sizeof(LD_BYTES_CODE)))
+        return;
+    _load_trap.pending = true;
+    _load_trap.af_ = _cpu.state.af_.value_uint16;
+    _load_trap.ix = _cpu.state.ix.value_uint16;
+    _load_trap.de = _cpu.state.de.value_uint16;
+    _load_trap.sp = _cpu.state.sp;
+    _load_trap.ear = _bus->ear();
+    _scheduler.schedule(_scheduler.now(), [this](uint64_t) { load_trap(); });
+}
+
+// Блок ленты ложится в память через таблицу страниц, регистры - как
+// у LD-BYTES на выходе: IX за данными, DE - недочитанное, L - последний
+// байт, H - контрольная сумма, флаги от CP 1 (CF - успех). B - из LD B,B0
+// после байта (0 - блок оборвался, у ПЗУ это таймаут фронта), C и AF' -
+// как после фронтов блока с деки от уровня EAR на входе. Остальные
+// регистры не меняются, как и у ПЗУ. Возврат через SA/LD-RET: бордюр,
+// EI, проверка BREAK и RET к вызвавшему.
+// Блок не в кодировке ПЗУ остаётся на ленте, и она играет: загрузчик
+// получает настоящие импульсы
+void Machine::load_trap()
+{
+    RomTrap trap = _load_trap;
+    _load_trap.pending = false;
+    uint16_t pc = _cpu.state.pc;
+    if (pc < LD_BYTES or pc > LD_EDGE_END or not code_mapped(LD_BYTES, LD_BYTES_CODE, sizeof(LD_BYTES_CODE))
+        or _cpu.state.ix.value_uint16 != trap.ix or _cpu.state.de.value_uint16 != trap.de)
+        return;
+
+    const uint8_t *data = nullptr;
+    uint32_t size = 0;
+    if (not _tape.take_rom_block(data, size))
+        return;
+
+    uint8_t flag = uint8_t(trap.af_ >> 8);
+    bool load = trap.af_ & 0x01;
+    uint16_t ix = trap.ix;
+    uint16_t de = trap.de;
+    uint8_t parity = size ? data[0] : 0;
+    uint8_t last = parity;
+    uint8_t a = uint8_t(parity ^ flag);  // при ошибке - как у XOR L; RET NZ
+    bool ok = size > 0 and a == 0;
+    bool mismatch = not ok;             // выход по RET NZ в LD-LOOP
+    bool cut = false;
+    uint32_t pos = 1;
+    while (ok and de > 0) {
+        if (pos == size) {
+            ok = false;                 // блок короче запрошенного
+            cut = true;
+            a = 0;
+            break;
+        }
+        last = data[pos++];
+        parity ^= last;
+        if (not load) {
+            a = _bus->page_read8(ix) ^ last;
+            if (a != 0) {
+                ok = false;             // VERIFY: выход на несовпавшем байте
+                mismatch = true;
+                break;
+            }
+        }
+        if (load)
+            _bus->page_write8(ix, last);
+        ix++;
+        de--;
+    }
+    if (ok and pos < size) {
+        last = data[pos];               // контрольная сумма
+        parity ^= last;
+    } else if (ok) {
+        ok = false;
+        cut = true;
+        a = 0;
+    }
+
+    // Успех - A = сумма и флаги CP 1 (CF при нулевой сумме), ошибка -
+    // флаги XOR: CF сброшен
+    uint8_t f;
+    if (ok) {
+        uint8_t r = uint8_t(parity - 1);
+        a = parity;
+        f = (r & 0x80) | (r == 0 ? 0x40 : 0) | ((parity & 0x0F) == 0 ? 0x10 : 0)
+          | (parity == 0x80 ? 0x04 : 0) | 0x02 | (parity == 0 ? 0x01 : 0);
+    } else
+        f = logic_flags(a);
+
+    // C на входе - 02 и бит 5 от EAR, дополняется на каждом фронте, так
+    // что после синхроимпульсов бит 5 - уровень данных (у блоков с деки
+    // низкий), а остальные биты перевёрнуты, если он не совпал с уровнем
+    // на входе. Дальше XOR 03 - бордюр синий/жёлтый. На флаге RL C; при
+    // совпадении RRA возвращает его без бита 7, и в AF' остаётся A = C
+    // и флаги RRA с CF = LOAD. Каждый байт - чётное число фронтов, так
+    // что дальше C не меняется. VERIFY кладёт в AF' результат XOR L = 0,
+    // выход по RET NZ оставляет там OR D,E перед LD-LOOP
+    uint8_t c = trap.ear ? 0x22 : 0x02;
+    if (trap.ear)
+        c = uint8_t(~c);
+    c ^= 0x03;
+    uint16_t af_;
+    if (mismatch and pos == 1) {
+        c = uint8_t(c << 1 | (load ? 1 : 0));
+        af_ = uint16_t((trap.de >> 8 | trap.de) & 0xFF) << 8;
+        af_ |= logic_flags(uint8_t(af_ >> 8));
+    } else if (mismatch) {
+        c &= 0x7F;
+        af_ = uint16_t((de >> 8 | de) & 0xFF) << 8;
+        af_ |= logic_flags(uint8_t(af_ >> 8));
+    } else {
+        c &= 0x7F;
+        if (not load and de != trap.de)
+            af_ = 0x0044;
+        else
+            af_ = uint16_t(c << 8 | 0x44 | (c & 0x28) | (load ? 0x01 : 0));
+    }
+
+    _cpu.state.af.value_uint16 = uint16_t(a << 8 | f);
+    _cpu.state.af_.value_uint16 = af_;
+    _cpu.state.bc.value_uint16 = uint16_t((cut ? 0x00 : 0xB0) << 8 | c);
+    _cpu.state.hl.value_uint16 = uint16_t(parity << 8 | last);
+    _cpu.state.ix.value_uint16 = ix;
+    _cpu.state.de.value_uint16 = de;
+    _cpu.state.sp = trap.sp;
+    _cpu.state.pc = SA_LD_RET;
+    if (_jit) _jit->flush();
+}
+
+// Как у LD-BYTES: срабатывание - событием после текущего прогона CPU,
+// пока SA-BYTES выдаёт пилот. Блок длиной FFFF в TAP и 10h не
+// помещается - его SA-BYTES пишет фронтами. В .tap фронтов нет: такой
+// блок теряется, и запись кончается ошибкой, а не молча
+void Machine::sa_bytes_entered()
+{
+    uint16_t hl = _cpu.state.hl.value_uint16;
+    if (_cpu.state.pc != SA_LEADER_OUT_NEXT or _save_trap.pending
+        or (hl != SA_HEADER_PILOT and hl != SA_DATA_PILOT)
+        or not code_mapped(SA_BYTES_CODE_ADDR, SA_BYTES_CODE, sizeof(SA_BYTES_CODE)))
+        return;
+    if (_cpu.state.de.value_uint16 == 0) {
+        if (not _recorder.records_edges()) {
+            _recorder.lose_block(QString("A block too long for .tap is not saved: ") + _recorder.filename());
+            fail(_recorder.error());
+        }
+        return;
+    }
+    _save_trap.pending = true;
+    _save_trap.af_ = _cpu.state.af_.value_uint16;
+    _save_trap.ix = _cpu.state.ix.value_uint16;
+    _save_trap.de = _cpu.state.de.value_uint16;
+    _save_trap.sp = _cpu.state.sp;
+    _save_trap.mic = _mic;
+    _scheduler.schedule(_scheduler.now(), [this](uint64_t) { save_trap(); });
+}
+
+// Блок читается из памяти через таблицу страниц: флаг - A', данные -
+// DE-1 байт с IX+1 (в пилоте IX и DE уже сдвинуты SA-BYTES). Регистры -
+// как у SA-BYTES на выходе: IX за контрольной суммой, DE = FFFF,
+// HL и B обнулены сдвигами, A = 0 и флаги от INC A (CF - BREAK не
+// нажат). Возврат через SA/LD-RET, его адрес со стека снимается. Уровень
+// MIC - как до пилота: выданный кусок пилота в запись фронтов не попал
+void Machine::save_trap()
+{
+    RomTrap trap = _save_trap;
+    _save_trap.pending = false;
+    uint16_t pc = _cpu.state.pc;
+    if (pc < SA_BYTES or pc >= SA_LD_RET or not _recorder.recording()
+        or not code_mapped(SA_BYTES_CODE_ADDR, SA_BYTES_CODE, sizeof(SA_BYTES_CODE))
+        or _cpu.state.sp != trap.sp
+        or _cpu.state.ix.value_uint16 != trap.ix or _cpu.state.de.value_uint16 != trap.de)
+        return;
+
+    uint8_t parity = uint8_t(trap.af_ >> 8);
+    uint16_t ix = uint16_t(trap.ix + 1);
+    uint16_t length = uint16_t(trap.de - 1);
+    QByteArray block;
+    block.reserve(length + 2);
+    block.append(char(parity));
+    for (uint16_t i = 0; i < length; i++) {
+        uint8_t value = _bus->page_read8(ix++);
+        parity ^= value;
+        block.append(char(value));
+    }
+    block.append(char(parity));
+    _recorder.rom_block(block);
+
+    _mic = trap.mic;
+    _cpu.state.af.value_uint16 = 0x0051;
+    _cpu.state.bc.value_uint16 = 0x000E;
+    _cpu.state.hl.value_uint16 = 0;
+    _cpu.state.ix.value_uint16 = uint16_t(ix + 1);
+    _cpu.state.de.value_uint16 = 0xFFFF;
+    _cpu.state.sp = uint16_t(trap.sp + 2);
+    _cpu.state.pc = SA_LD_RET;
+    if (_jit) _jit->flush();
+}
+
+// Ускорение загрузчиков. Ожидание фронта у всех загрузчиков устроено
+// одинаково: IN из FE, проверка бита EAR, счётчик в регистре на 1 за
+// проход. Прогон CPU кончается не позже события следующего фронта (как
+// и любого другого события), и до конца прогона порт читает одно и то
+// же. Поэтому, когда цикл опознан, проходы до конца прогона не
+// исполняются: счётчик, R и такты сразу сдвигаются на их число, как
+// будто CPU их прошёл. Счётчик не доводится до переполнения - выход по
+// таймауту загрузчик сделает сам.
+//
+// Проход - два чтения с одного PC в одном прогоне, между которыми ровно
+// один из B, C, D, E, H, L сдвинулся на +-1, а остальные и SP на месте.
+// Цикл с записью в память так не отличить, поэтому ускорение работает
+// только пока лента играет. Опознаётся цикл и без ускорения: по нему
+// tape_loading() видит, что ленту читают
+void Machine::ear_read()
+{
+    EdgeLoop &loop = _edge_loop;
+    if (not _tape.playing()) {
+        loop.passes = 0;
+        return;
+    }
+
+    ZZ80State &state = _cpu.state;
+    uint8_t *counters[EdgeLoop::COUNTERS] = {
+        &state.bc.values_uint8.index1, &state.bc.values_uint8.index0,
+        &state.de.values_uint8.index1, &state.de.values_uint8.index0,
+        &state.hl.values_uint8.index1, &state.hl.values_uint8.index0
+    };
+    uint64_t now = _bus->now();
+    uint32_t pass = uint32_t(std::min<uint64_t>(now - loop.time, UINT32_MAX));
+
+    int counter = -1;
+    int step = 0;
+    if (_run_start == loop.run and state.pc == loop.pc and state.sp == loop.sp
+        and pass <= EdgeLoop::MAX_PASS) {
+        for (int i = 0; i < EdgeLoop::COUNTERS; i++) {
+            uint8_t delta = uint8_t(*counters[i] - loop.counters[i]);
+            if (delta == 0)
+                continue;
+            if (counter >= 0 or (delta != 1 and delta != 0xFF)) {
+                counter = -1;
+                break;
+            }
+            counter = i;
+            step = delta == 1 ? 1 : -1;
+        }
+    }
+
+    // Опознанный цикл держится, пока подряд не пройдёт MIN_PASSES других
+    // проходов: вход в него заново (задержка в LD-EDGE-1) его не сбивает
+    uint8_t r_step = uint8_t((state.r - loop.r) & 0x7F);
+    bool known = false;
+    if (counter >= 0) {
+        if (state.pc == loop.loop_pc and counter == loop.counter and step == loop.step
+            and pass == loop.pass and r_step == loop.r_step) {
+            loop.passes++;
+            loop.misses = 0;
+            known = loop.passes >= EdgeLoop::MIN_PASSES;
+        } else if (loop.passes < EdgeLoop::MIN_PASSES or ++loop.misses >= EdgeLoop::MIN_PASSES) {
+            loop.loop_pc = state.pc;
+            loop.counter = counter;
+            loop.step = step;
+            loop.pass = pass;
+            loop.r_step = r_step;
+            loop.passes = 1;
+            loop.misses = 0;
+        }
+    }
+
+    if (known)
+        _loading_until = _frames + LOADING_FRAMES;
+    if (known and _accelerate_loaders and _cpu.cycle_limit > _cpu.cycles) {
+        uint8_t value = *counters[counter];
+        uint32_t room = step > 0 ? 0xFFu - value : (value > 0 ? value - 1u : 0u);
+        // Инструкция, начатая на самой границе прогона, исполнилась бы
+        // уже после события: IN должен остаться строго до неё
+        uint32_t skip = uint32_t(std::min<uint64_t>((_cpu.cycle_limit - _cpu.cycles - 1) / pass, room));
+        if (skip > 0) {
+            *counters[counter] = uint8_t(value + step * int(skip));
+            state.r = uint8_t((state.r & 0x80) | ((state.r + skip * r_step) & 0x7F));
+            _cpu.cycles += zusize(skip) * pass;
+            now += uint64_t(skip) * pass;
+        }
+    }
+
+    loop.run = _run_start;
+    loop.pc = state.pc;
+    loop.sp = state.sp;
+    loop.time = now;
+    for (int i = 0; i < EdgeLoop::COUNTERS; i++)
+        loop.counters[i] = *counters[i];
+    loop.r = state.r;
+}
+
+bool Machine::load_scr(const QString &filename)
+{
+    QFile scr_file(filename);
+    if (not scr_file.open(QIODevice::ReadOnly))
+        return fail(QString("Can't open a screen file: ") + filename);
+
+    QByteArray buffer = scr_file.readAll();
+    write_memory(SCREEN_ADDR, reinterpret_cast<const uint8_t *>(buffer.constData()),
+                 std::min(buffer.size(), SCREEN_SIZE));
+    return true;
+}
+
+bool Machine::save_scr(const QString &filename)
+{
+    QFile scr_file(filename);
+    if (not scr_file.open(QIODevice::WriteOnly))
+        return fail(QString("Can't write a screen file: ") + filename);
+
+    QByteArray buffer(SCREEN_SIZE, 0);
+    for (int off = 0; off < SCREEN_SIZE; off++)
+        buffer[off] = _bus->mem_read8(SCREEN_ADDR + off);
+    scr_file.write(buffer);
+    return true;
+}
@@ -0,0 +1,189 @@
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <QString>
+#include <memory>
+#include "beeper.h"
+#include "businterface.h"
+#include "frame.h"
+#include "scheduler.h"
+#include "tapedeck.h"
+#include "taperecorder.h"
+#include "z80jit.h"
+#include "emulation/CPU/Z80.h"
+
+// Спектрум целиком: CPU, шина с памятью и портами, кадры по планировщику.
+// Ни виджетов, ни цикла событий - кадры гоняет тот, кто владеет машиной:
+// GUI по таймеру, консольный запуск и бенчмарки - подряд без пауз.
+class Machine
+{
+public:
+    enum Model {
+        MODEL_48K  = 0,
+        MODEL_128K = 1
+    };
+
+    explicit Machine(Model model = MODEL_128K, const QString &rom_file = QString());
+    Machine(const Machine &) = delete;
+    Machine & operator=(const Machine &) = delete;
+
+    // Смена модели - как включение питания. Пустой rom_file - ПЗУ модели
+    // из rom/. false, если ПЗУ не загрузилось (машина работает с пустым
+    // ПЗУ), причина в error()
+    bool set_model(Model model, const QString &rom_file = QString());
+    Model model() const { return _model; }
+
+    // Кэш трансляции горячего кода (z80jit.h); по умолчанию включён
+    // при сборке ядра с CONFIG+=z80_jit
+    void set_jit(bool enabled);
+    const Z80Jit * jit() const { return _jit.get(); }
+
+    void reset();
+    void nmi();
+
+    // Один кадр: от начала INT до начала следующего
+    void run_frame();
+    uint64_t frames() const { return _frames; }
+    uint64_t cycles() const { return _scheduler.now(); }
+    // Такт начала следующего кадра (того, что прогонит run_frame)
+    uint64_t next_frame() const { return _next_frame; }
+
+    // Снимок только что законченного кадра для вывода (FrameQueue):
+    // экран, изменившиеся с прошлого снимка знакоместа, бордюр по строкам
+    void capture_frame(Frame &frame);
+
+    // Звук бипера: частота вывода и сэмплы (моно) прошедшего кадра
+    void set_sample_rate(int rate);
+    int sample_rate() const { return _beeper.sample_rate(); }
+    // Множитель частоты вывода со следующего кадра (AudioStream):
+    // сэмплов за кадр на долю процента больше или меньше
+    void set_rate_adjust(double factor);
+    const std::vector<int16_t> & audio() const { return _audio; }
+
+    bool load_sna(const QString &filename);
+    bool load_z80(const QString &filename);
+    bool save_z80(const QString &filename);
+    bool load_scr(const QString &filename);
+    bool save_scr(const QString &filename);
+
+    // Лента (.tap, .tzx) в магнитофоне: вставляется остановленной,
+    // играет по play()
+    bool load_tape(const QString &filename);
+    TapeDeck & tape() { return _tape; }
+    // Мгновенная загрузка: вызов LD-BYTES ПЗУ получает блок ленты сразу,
+    // без импульсов. Нестандартные загрузчики ловушку не задевают и
+    // читают ленту как есть. Так же при записи ленты SA-BYTES отдаёт
+    // блок в файл прямо из памяти. По умолчанию включена
+    void set_tape_traps(bool enabled);
+    bool tape_traps() const { return _tape_traps; }
+    // Ускорение загрузчиков, которые ловушка не берёт: пока лента играет,
+    // опознанный цикл ожидания фронта проскакивает до следующего фронта.
+    // Результат тот же, что без ускорения. По умолчанию включено
+    void set_loader_acceleration(bool enabled);
+    bool loader_acceleration() const { return _accelerate_loaders; }
+    // Лента играет и её читает загрузчик: опознанный цикл ожидания фронта
+    // был не раньше LOADING_FRAMES кадров назад (при любом ускорении).
+    // Опрос клавиатуры читает тот же порт FE, но таким циклом не бывает
+    static constexpr uint64_t LOADING_FRAMES = 16;
+    bool tape_loading() const { return _tape.playing() and _frames < _loading_until; }
+
+    // Запись ленты в файл (TapeRecorder), формат - по расширению: .tap,
+    // .tzx или .csw. Блоки SA-BYTES идут через ловушку, остальное
+    // пишется фронтами MIC (кроме .tap)
+    bool record_tape(const QString &filename);
+    // false - не всё записалось, причина в error()
+    bool stop_recording();
+    const TapeRecorder & recorder() const { return _recorder; }
+
+    // Причина последней неудачи set_model/load_*/save_*
+    const QString & error() const { return _error; }
+
+    BusInterface * bus() const { return _bus.get(); }
+    Z80 & cpu() { return _cpu; }
+    const Z80 & cpu() const { return _cpu; }
+    Scheduler & scheduler() { return _scheduler; }
+
+private:
+    zusize run_cpu(zusize cycles);
+    void start_frames();
+    void schedule_frame(uint64_t when);
+    void write_memory(uint32_t address, const uint8_t *data, int size);
+    void install_tape_hooks();
+    void fe_written();
+    bool code_mapped(uint16_t address, const uint8_t *code, size_t size) const;
+    void ld_bytes_entered();
+    void load_trap();
+    void sa_bytes_entered();
+    void save_trap();
+    void ear_read();
+    void end_frame();
+    bool fail(const QString &error);
+
+    Model _model { MODEL_128K };
+    std::unique_ptr<BusInterface> _bus;
+    std::unique_ptr<Z80Jit> _jit;      // держит указатель на _bus
+    bool _use_jit { false };
+    Z80 _cpu {};
+    Scheduler _scheduler { [this](zusize cycles) { return run_cpu(cycles); } };
+    uint64_t _next_frame { 0 };        // такт начала следующего кадра
+    uint64_t _frames { 0 };
+    uint64_t _run_start { 0 };         // такт начала текущего run_cpu
+    TapeDeck _tape { _scheduler, [this](bool level) { _bus->set_ear(level); } };
+    bool _tape_traps { true };
+
+    TapeRecorder _recorder;
+    bool _mic { false };               // выход MIC после последней записи в FE
+
+    // Регистры на входе в LD-BYTES или SA-BYTES до срабатывания ловушки
+    struct RomTrap
+    {
+        bool pending { false };
+        uint16_t af_ { 0 };            // A' - флаг блока, у LD-BYTES CF' - LOAD, иначе VERIFY
+        uint16_t ix { 0 };
+        uint16_t de { 0 };
+        uint16_t sp { 0 };
+        bool ear { false };            // у LD-BYTES - уровень EAR на входе
+        bool mic { false };            // у SA-BYTES - MIC до пилота
+    };
+    RomTrap _load_trap;
+    RomTrap _save_trap;
+
+    bool _accelerate_loaders { true };
+    uint64_t _loading_until { 0 };     // кадр, до которого tape_loading()
+
+    // Цикл ожидания фронта (ear_read): прошлое чтение FE и признаки
+    // опознанного цикла
+    struct EdgeLoop
+    {
+        static constexpr int COUNTERS = 6;      // B, C, D, E, H, L
+        static constexpr uint32_t MAX_PASS = 512;
+        static constexpr int MIN_PASSES = 8;    // подряд, чтобы ускорять
+
+        uint64_t run { 0 };                     // _run_start прогона
+        uint16_t pc { 0 };
+        uint16_t sp { 0 };
+        uint64_t time { 0 };
+        uint8_t counters[COUNTERS] {};
+        uint8_t r { 0 };
+
+        uint16_t loop_pc { 0 };
+        int counter { -1 };
+        int step { 0 };
+        uint32_t pass { 0 };                    // тактов на проход
+        uint8_t r_step { 0 };
+        int passes { 0 };
+        int misses { 0 };
+    };
+    EdgeLoop _edge_loop;
+
+    // Бордюр прошедшего кадра по строкам, собранный из лога шины
+    uint8_t _border_lines[Frame::MAX_LINES] {};
+    uint8_t _border { 0 };             // цвет на начало следующего кадра
+    const uint8_t * _captured_vram { nullptr };
+
+    Beeper _beeper;
+    std::vector<int16_t> _audio;       // сэмплы прошедшего кадра
+    QString _error;
+};
+
+#endif // MACHINE_H
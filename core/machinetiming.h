@@ -0,0 +1,26 @@
+#ifndef MACHINETIMING_H
+#define MACHINETIMING_H
+
+#include <cstdint>
+
+// Длительности кадра, сигнала INT и строки развёртки в тактах CPU,
+// первая строка области точек (считая от начала INT), частоты CPU и
+// AY (0 - AY нет)
+struct MachineTiming
+{
+    uint32_t frame_cycles;
+    uint32_t int_cycles;
+    uint32_t line_cycles;
+    uint32_t screen_line;
+    uint32_t cpu_hz;
+    uint32_t ay_hz;
+
+    // Кадров в секунду: 50.08 у 48К, 50.02 у 128К
+    double frame_rate() const { return double(cpu_hz) / frame_cycles; }
+};
+
+static constexpr MachineTiming TIMING_48K { 69888, 32, 224, 64, 3500000, 0 };
+static constexpr MachineTiming TIMING_128K { 70908, 36, 228, 63, 3546900, 1773450 };
+static constexpr MachineTiming TIMING_PENTAGON { 71680, 32, 224, 80, 3500000, 1750000 };
+
+#endif // MACHINETIMING_H
@@ -5,7 +5,6 @@
 
 class Port1F : public BusDevice
 {
-    Q_OBJECT
 public:
     Port1F();
 
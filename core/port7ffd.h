@@ -5,7 +5,6 @@
 
 class Port7FFD : public BusDevice
 {
-    Q_OBJECT
 public:
     Port7FFD();
 
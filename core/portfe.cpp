@@ -0,0 +1,47 @@
+#include "portfe.h"
+
+PortFE::PortFE()
+{
+    rebuild_rows();
+}
+
+uint8_t PortFE::read8(uint32_t address)
+{
+    return _rows[(address >> 8) & 0xff] | _ear;
+}
+
+void PortFE::write8(uint32_t address, uint8_t value)
+{
+    Q_UNUSED(address);
+    _fe_data = value;
+}
+
+void PortFE::press_key(int row, int col)
+{
+    uint8_t old = _key_matrix[col - 8];
+    _key_matrix[col - 8] &= ~(1 << row);
+    if (_key_matrix[col - 8] != old)
+        rebuild_rows();
+}
+
+void PortFE::release_key(int row, int col)
+{
+    uint8_t old = _key_matrix[col - 8];
+    _key_matrix[col - 8] |= (1 << row);
+    if (_key_matrix[col - 8] != old)
+        rebuild_rows();
+}
+
+// Нулевой бит старшего байта адреса выбирает полуряд. Строка для
+// набора полурядов - строка без младшего из них И его ряд клавиш,
+// поэтому таблица строится от 0xFF вниз за 256 шагов
+void PortFE::rebuild_rows()
+{
+    _rows[0xff] = uint8_t(~EAR_BIT);
+    for (int select = 0xfe; select >= 0; select--) {
+        int row = 0;
+        while (select & (1 << row))
+            row++;
+        _rows[select] = _rows[select | (1 << row)] & _key_matrix[row] & uint8_t(~EAR_BIT);
+    }
+}
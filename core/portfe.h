@@ -0,0 +1,41 @@
+#ifndef PORTFE_H
+#define PORTFE_H
+
+#include "busdevice.h"
+
+class PortFE : public BusDevice
+{
+public:
+    PortFE();
+
+    uint8_t read8(uint32_t address) override;
+    void write8(uint32_t address, uint8_t value) override;
+
+    int border() const { return _fe_data & 0b00000111;}
+    int tape_out() const { return !!(_fe_data &0b00001000);}
+    int beeper_out() const { return !!(_fe_data &0b00010000);}
+    // Уровень на динамике: MIC (бит 0) и EAR (бит 1), 0..3
+    int speaker() const { return (_fe_data >> 3) & 0b11;}
+
+    void press_key(int row, int col);
+    void release_key(int row, int col);
+
+    // Уровень на входе EAR (бит 6 при чтении): магнитофон
+    void set_ear(bool level) { _ear = level ? EAR_BIT : 0; }
+    bool ear() const { return _ear; }
+
+    static constexpr uint8_t EAR_BIT = 0b01000000;
+
+private:
+    void rebuild_rows();
+
+    uint8_t _key_matrix[8] { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    // Результат чтения для каждого старшего байта адреса (выбранных
+    // полурядов) без бита EAR. Пересчитывается при смене клавиши:
+    // KEY-SCAN и игры читают порт тысячи раз за кадр, клавиши меняются редко
+    uint8_t _rows[256];
+    uint8_t _ear { EAR_BIT };
+    uint8_t _fe_data { 0 };
+};
+
+#endif // PORTFE_H
@@ -24,3 +24,8 @@ const uint8_t *RAMDevice::getBuffer(uint32_t address) const
 {
     return &_data.data()[address % _data.size()];
 }
+
+uint8_t *RAMDevice::page(int n)
+{
+    return &_data.data()[(n * 0x4000) % _data.size()];
+}
@@ -5,7 +5,6 @@
 
 class RAMDevice : public BusDevice
 {
-    Q_OBJECT
 public:
     RAMDevice(int width);
 
@@ -13,6 +12,7 @@ public:
     void write8(uint32_t address, uint8_t value) override;
 
     const uint8_t *getBuffer(uint32_t address) const;
+    uint8_t *page(int n);
 
 private:
     QVector<uint8_t> _data;
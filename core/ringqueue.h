@@ -0,0 +1,46 @@
+#ifndef RINGQUEUE_H
+#define RINGQUEUE_H
+
+#include <Z/classes/buffering/RingBuffer.hpp>
+
+// Очередь на N элементов между двумя потоками (один пишет, один читает)
+// поверх кольцевого буфера Z (RingBuffer.hpp). Без блокировок и без
+// ожидания: push() в полную очередь и pop() из пустой сразу возвращают
+// false. Блокирующие produce()/consume() из Z не используются - они
+// крутятся на x86-инструкции pause.
+template <class T, int N>
+class RingQueue
+{
+public:
+    RingQueue() { _ring.initialize(_items, sizeof(T), N); }
+    RingQueue(const RingQueue &) = delete;
+    RingQueue & operator=(const RingQueue &) = delete;
+
+    bool push(const T &item)
+    {
+        T *slot = static_cast<T *>(_ring.production_buffer());
+        if (not slot)
+            return false;
+        *slot = item;
+        _ring.try_produce();
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        T *slot = static_cast<T *>(_ring.consumption_buffer());
+        if (not slot)
+            return false;
+        item = *slot;
+        _ring.try_consume();
+        return true;
+    }
+
+    bool empty() const { return not _ring.consumption_buffer(); }
+
+private:
+    T _items[N];
+    Zeta::RingBuffer _ring;
+};
+
+#endif // RINGQUEUE_H
@@ -0,0 +1,39 @@
+#include "romdevice.h"
+#include <QFile>
+#include <QDebug>
+#include <algorithm>
+
+ROMDevice::ROMDevice(const QString &filename)
+    : _filename(filename)
+{
+    QFile romfile(filename);
+
+    if (romfile.open(QIODevice::ReadOnly))
+    {
+        _data = romfile.readAll();
+        _loaded = _data.size() > 0;
+    }
+    if (not _loaded)
+        qWarning() << "Can't load a ROM file:" << filename;
+
+    // дополняем до целого числа страниц по 16К
+    int pages = std::max((_data.size() + 0x3fff) / 0x4000, 1);
+    _data.append(QByteArray(pages * 0x4000 - _data.size(), char(0xff)));
+}
+
+uint8_t ROMDevice::read8(uint32_t address)
+{
+    return _data[address % _data.size()];
+}
+
+void ROMDevice::write8(uint32_t address, uint8_t value)
+{
+    Q_UNUSED(address);
+    Q_UNUSED(value);
+}
+
+const uint8_t *ROMDevice::page(int n) const
+{
+    return reinterpret_cast<const uint8_t *>(_data.constData()) +
+            (n * 0x4000) % _data.size();
+}
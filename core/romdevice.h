@@ -0,0 +1,28 @@
+#ifndef ROMDEVICE_H
+#define ROMDEVICE_H
+
+#include <QByteArray>
+#include <QString>
+#include "busdevice.h"
+
+class ROMDevice : public BusDevice
+{
+public:
+    ROMDevice(const QString &filename);
+
+    uint8_t read8(uint32_t address) override;
+    void write8(uint32_t address, uint8_t value) override;
+
+    const uint8_t *page(int n) const;
+
+    // Файл не прочитался: вместо ПЗУ одна страница с FF
+    bool loaded() const { return _loaded; }
+    const QString & filename() const { return _filename; }
+
+private:
+    QByteArray _data;
+    QString _filename;
+    bool _loaded { false };
+};
+
+#endif // ROMDEVICE_H
@@ -0,0 +1,57 @@
+#include "scheduler.h"
+
+#include <algorithm>
+
+Scheduler::Scheduler(CpuRun cpu_run)
+    : _cpu_run(std::move(cpu_run))
+{
+}
+
+uint64_t Scheduler::schedule(uint64_t when, Callback callback)
+{
+    uint64_t id = _next_id++;
+    _queue.push_back({ when, id, std::move(callback) });
+    std::push_heap(_queue.begin(), _queue.end(), Later());
+    return id;
+}
+
+void Scheduler::cancel(uint64_t id)
+{
+    _cancelled.insert(id);
+}
+
+uint64_t Scheduler::next_event() const
+{
+    return _queue.empty() ? UINT64_MAX : _queue.front().when;
+}
+
+void Scheduler::run_until(uint64_t when)
+{
+    dispatch();
+    while (_now < when) {
+        uint64_t stop = std::min(when, next_event());
+        _now += _cpu_run(zusize(stop - _now));
+        dispatch();
+    }
+}
+
+void Scheduler::clear()
+{
+    _queue.clear();
+    _cancelled.clear();
+    _now = 0;
+}
+
+// Исполняет все события с меткой не позже now(). Обработчик может
+// ставить новые события, в том числе уже созревшие.
+void Scheduler::dispatch()
+{
+    while (not _queue.empty() and _queue.front().when <= _now) {
+        std::pop_heap(_queue.begin(), _queue.end(), Later());
+        Event event = std::move(_queue.back());
+        _queue.pop_back();
+        if (_cancelled.erase(event.id))
+            continue;
+        event.callback(event.when);
+    }
+}
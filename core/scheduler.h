@@ -0,0 +1,66 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cstdint>
+#include <functional>
+#include <unordered_set>
+#include <vector>
+#include "emulation/CPU/Z80.h"
+#include "machinetiming.h"
+
+// Планировщик событий с меткой времени в тактах от включения машины
+// (начало и конец INT, точки выборки звука, фронты ленты и т.п.).
+// run_until() гоняет CPU ровно до ближайшего события, исполняет все
+// созревшие события по порядку и продолжает. CPU останавливается на
+// границе инструкции, поэтому событие может исполниться на несколько
+// тактов позже своей метки; now() показывает фактическое время.
+class Scheduler
+{
+public:
+    using Callback = std::function<void (uint64_t when)>;
+    using CpuRun = std::function<zusize (zusize cycles)>;
+
+    explicit Scheduler(CpuRun cpu_run);
+
+    uint64_t now() const { return _now; }
+    const MachineTiming & timing() const { return _timing; }
+    void set_timing(const MachineTiming &timing) { _timing = timing; }
+
+    // Номер события для cancel()
+    uint64_t schedule(uint64_t when, Callback callback);
+    uint64_t schedule_in(uint64_t delay, Callback callback)
+    { return schedule(_now + delay, std::move(callback)); }
+    void cancel(uint64_t id);
+
+    // Время ближайшего события, UINT64_MAX если очередь пуста
+    uint64_t next_event() const;
+
+    void run_until(uint64_t when);
+
+    // Сброс времени и очереди (reset, смена модели)
+    void clear();
+
+private:
+    struct Event
+    {
+        uint64_t when;
+        uint64_t id;        // порядок событий с одинаковым временем
+        Callback callback;
+    };
+    struct Later
+    {
+        bool operator()(const Event &a, const Event &b) const
+        { return a.when != b.when ? a.when > b.when : a.id > b.id; }
+    };
+
+    void dispatch();
+
+    CpuRun _cpu_run;
+    MachineTiming _timing { TIMING_48K };
+    uint64_t _now { 0 };
+    uint64_t _next_id { 0 };
+    std::vector<Event> _queue;  // min-heap по when
+    std::unordered_set<uint64_t> _cancelled;
+};
+
+#endif // SCHEDULER_H
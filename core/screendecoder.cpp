@@ -0,0 +1,328 @@
+#include "screendecoder.h"
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SCREEN_X86
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCREEN_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define SCREEN_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SCREEN_NEON
+#include <arm_neon.h>
+#endif
+
+// Маски битов для каждой выходной точки строки знакоместа: при масштабе
+// S точка i берёт бит 0x80 >> (i / S)
+template <int S>
+struct Masks
+{
+    alignas(32) uint32_t bit[8 * S];
+
+    Masks()
+    {
+        for (int i = 0; i < 8 * S; i++)
+            bit[i] = 0x80u >> (i / S);
+    }
+};
+
+static const Masks<1> s_masks1;
+static const Masks<2> s_masks2;
+static const Masks<4> s_masks4;
+
+template <int S> static const uint32_t * masks();
+template <> const uint32_t * masks<1>() { return s_masks1.bit; }
+template <> const uint32_t * masks<2>() { return s_masks2.bit; }
+template <> const uint32_t * masks<4>() { return s_masks4.bit; }
+
+// --- Скалярное ядро ------------------------------------------------------
+
+static void row_scaled(const uint8_t *pixels, const uint8_t *attrs,
+                       const uint32_t *ink, const uint32_t *paper,
+                       uint32_t *out, int cells, int scale)
+{
+    for (int ax = 0; ax < cells; ax++) {
+        uint8_t data = pixels[ax];
+        uint32_t fg = ink[attrs[ax]];
+        uint32_t bg = paper[attrs[ax]];
+        for (int px = 0; px < 8; px++) {
+            uint32_t color = (data & (0b10000000 >> px)) ? fg : bg;
+            for (int s = 0; s < scale; s++)
+                *out++ = color;
+        }
+    }
+}
+
+template <int S>
+static void row_scalar(const uint8_t *pixels, const uint8_t *attrs,
+                       const uint32_t *ink, const uint32_t *paper,
+                       uint32_t *out, int cells)
+{
+    row_scaled(pixels, attrs, ink, paper, out, cells, S);
+}
+
+// --- SSE2: 4 точки за операцию -------------------------------------------
+
+#ifdef SCREEN_SSE2
+template <int S>
+static void row_sse2(const uint8_t *pixels, const uint8_t *attrs,
+                     const uint32_t *ink, const uint32_t *paper,
+                     uint32_t *out, int cells)
+{
+    constexpr int N = 2 * S;    // векторов на знакоместо
+    __m128i mask[N];
+    for (int v = 0; v < N; v++)
+        mask[v] = _mm_load_si128(reinterpret_cast<const __m128i *>(masks<S>() + 4 * v));
+
+    for (int ax = 0; ax < cells; ax++) {
+        __m128i data = _mm_set1_epi32(pixels[ax]);
+        __m128i fg = _mm_set1_epi32(int(ink[attrs[ax]]));
+        __m128i bg = _mm_set1_epi32(int(paper[attrs[ax]]));
+        for (int v = 0; v < N; v++, out += 4) {
+            __m128i set = _mm_cmpeq_epi32(_mm_and_si128(data, mask[v]), mask[v]);
+            __m128i color = _mm_or_si128(_mm_and_si128(set, fg), _mm_andnot_si128(set, bg));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out), color);
+        }
+    }
+}
+#endif
+
+// --- AVX2: 8 точек за операцию -------------------------------------------
+
+#ifdef SCREEN_AVX2
+template <int S>
+TARGET_AVX2 static void row_avx2(const uint8_t *pixels, const uint8_t *attrs,
+                                 const uint32_t *ink, const uint32_t *paper,
+                                 uint32_t *out, int cells)
+{
+    constexpr int N = S;        // векторов на знакоместо
+    __m256i mask[N];
+    for (int v = 0; v < N; v++)
+        mask[v] = _mm256_load_si256(reinterpret_cast<const __m256i *>(masks<S>() + 8 * v));
+
+    for (int ax = 0; ax < cells; ax++) {
+        __m256i data = _mm256_set1_epi32(pixels[ax]);
+        __m256i fg = _mm256_set1_epi32(int(ink[attrs[ax]]));
+        __m256i bg = _mm256_set1_epi32(int(paper[attrs[ax]]));
+        for (int v = 0; v < N; v++, out += 8) {
+            __m256i set = _mm256_cmpeq_epi32(_mm256_and_si256(data, mask[v]), mask[v]);
+            __m256i color = _mm256_blendv_epi8(bg, fg, set);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), color);
+        }
+    }
+}
+#endif
+
+// --- NEON: 4 точки за операцию -------------------------------------------
+
+#ifdef SCREEN_NEON
+template <int S>
+static void row_neon(const uint8_t *pixels, const uint8_t *attrs,
+                     const uint32_t *ink, const uint32_t *paper,
+                     uint32_t *out, int cells)
+{
+    constexpr int N = 2 * S;
+    uint32x4_t mask[N];
+    for (int v = 0; v < N; v++)
+        mask[v] = vld1q_u32(masks<S>() + 4 * v);
+
+    for (int ax = 0; ax < cells; ax++) {
+        uint32x4_t data = vdupq_n_u32(pixels[ax]);
+        uint32x4_t fg = vdupq_n_u32(ink[attrs[ax]]);
+        uint32x4_t bg = vdupq_n_u32(paper[attrs[ax]]);
+        for (int v = 0; v < N; v++, out += 4)
+            vst1q_u32(out, vbslq_u32(vtstq_u32(data, mask[v]), fg, bg));
+    }
+}
+#endif
+
+// --- Выбор ядра ----------------------------------------------------------
+
+#ifdef SCREEN_AVX2
+static bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    bool osxsave = info[2] & (1 << 27);
+    bool avx = info[2] & (1 << 28);
+    if (not osxsave or not avx or (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+bool ScreenDecoder::kernel_supported(Kernel kernel)
+{
+    switch (kernel) {
+    case KERNEL_SCALAR: return true;
+#ifdef SCREEN_SSE2
+    case KERNEL_SSE2: return true;
+#endif
+#ifdef SCREEN_AVX2
+    case KERNEL_AVX2: { static const bool avx2 = cpu_has_avx2(); return avx2; }
+#endif
+#ifdef SCREEN_NEON
+    case KERNEL_NEON: return true;
+#endif
+    default: return false;
+    }
+}
+
+ScreenDecoder::Kernel ScreenDecoder::best_kernel()
+{
+    for (Kernel kernel : { KERNEL_AVX2, KERNEL_SSE2, KERNEL_NEON })
+        if (kernel_supported(kernel))
+            return kernel;
+    return KERNEL_SCALAR;
+}
+
+const char * ScreenDecoder::kernel_name(Kernel kernel)
+{
+    switch (kernel) {
+    case KERNEL_SSE2: return "SSE2";
+    case KERNEL_AVX2: return "AVX2";
+    case KERNEL_NEON: return "NEON";
+    default: return "scalar";
+    }
+}
+
+void ScreenDecoder::set_kernel(Kernel kernel)
+{
+    if (not kernel_supported(kernel))
+        kernel = KERNEL_SCALAR;
+    _kernel = kernel;
+
+    switch (kernel) {
+#ifdef SCREEN_SSE2
+    case KERNEL_SSE2:
+        _rows[0] = row_sse2<1>; _rows[1] = row_sse2<2>; _rows[2] = row_sse2<4>;
+        break;
+#endif
+#ifdef SCREEN_AVX2
+    case KERNEL_AVX2:
+        _rows[0] = row_avx2<1>; _rows[1] = row_avx2<2>; _rows[2] = row_avx2<4>;
+        break;
+#endif
+#ifdef SCREEN_NEON
+    case KERNEL_NEON:
+        _rows[0] = row_neon<1>; _rows[1] = row_neon<2>; _rows[2] = row_neon<4>;
+        break;
+#endif
+    default:
+        _rows[0] = row_scalar<1>; _rows[1] = row_scalar<2>; _rows[2] = row_scalar<4>;
+        break;
+    }
+}
+
+// --- Декодер -------------------------------------------------------------
+
+ScreenDecoder::ScreenDecoder()
+{
+    // y = Y7 Y6 Y5 Y4 Y3 Y2 Y1 Y0 -> адрес 0 0 0 Y7 Y6 Y2 Y1 Y0 Y5 Y4 Y3 0 0 0 0 0
+    for (int y = 0; y < HEIGHT; y++) {
+        _row_addr[y] = uint16_t(((y & 0b11000000) << 5) |
+                                ((y & 0b00000111) << 8) |
+                                ((y & 0b00111000) << 2));
+        _attr_addr[y] = uint16_t(PIXELS_SIZE + (y / 8) * ATTR_WIDTH);
+    }
+    set_kernel(best_kernel());
+}
+
+void ScreenDecoder::set_palette(const uint32_t palette[16])
+{
+    // FL BR PG PR PB IG IR IB
+    for (int attr = 0; attr < 256; attr++) {
+        int bright = (attr & 0b01000000) ? 8 : 0;
+        uint32_t ink = palette[(attr & 0b00000111) + bright];
+        uint32_t paper = palette[((attr & 0b00111000) >> 3) + bright];
+        bool flash = attr & 0b10000000;
+        _ink[0][attr] = ink;
+        _paper[0][attr] = paper;
+        _ink[1][attr] = flash ? paper : ink;
+        _paper[1][attr] = flash ? ink : paper;
+    }
+}
+
+void ScreenDecoder::decode(const uint8_t *vram, bool flash, uint32_t *out, int stride,
+                           int scale) const
+{
+    for (int y = 0; y < HEIGHT; y++)
+        decode_span(vram, flash, out, stride, scale, y, 0, ATTR_WIDTH);
+}
+
+void ScreenDecoder::decode_dirty(const uint8_t *vram, bool flash, uint32_t *out, int stride,
+                                 int scale, const uint32_t dirty[ATTR_HEIGHT]) const
+{
+    for (int cy = 0; cy < ATTR_HEIGHT; cy++) {
+        uint32_t mask = dirty[cy];
+        if (not mask)
+            continue;
+        // Подряд идущие грязные знакоместа разворачиваются одним вызовом ядра
+        for (int x = 0; x < ATTR_WIDTH;) {
+            if (not (mask & (1u << x))) {
+                x++;
+                continue;
+            }
+            int end = x + 1;
+            while (end < ATTR_WIDTH and (mask & (1u << end)))
+                end++;
+            for (int y = cy * 8; y < cy * 8 + 8; y++)
+                decode_span(vram, flash, out, stride, scale, y, x, end - x);
+            x = end;
+        }
+    }
+}
+
+void ScreenDecoder::mark_flash(const uint8_t *vram, uint32_t dirty[ATTR_HEIGHT])
+{
+    const uint8_t *attrs = vram + PIXELS_SIZE;
+    for (int cy = 0; cy < ATTR_HEIGHT; cy++)
+        for (int x = 0; x < ATTR_WIDTH; x++)
+            if (attrs[cy * ATTR_WIDTH + x] & 0b10000000)
+                dirty[cy] |= 1u << x;
+}
+
+void ScreenDecoder::decode_span(const uint8_t *vram, bool flash, uint32_t *out, int stride,
+                                int scale, int y, int x, int cells) const
+{
+    const uint32_t *ink = _ink[flash];
+    const uint32_t *paper = _paper[flash];
+    const uint8_t *pixels = vram + _row_addr[y] + x;
+    const uint8_t *attrs = vram + _attr_addr[y] + x;
+    RowKernel row = scale == 1 ? _rows[0] :
+                    scale == 2 ? _rows[1] :
+                    scale == 4 ? _rows[2] : nullptr;
+
+    uint32_t *first = out + y * scale * stride + x * 8 * scale;
+    if (row)
+        row(pixels, attrs, ink, paper, first, cells);
+    else
+        row_scaled(pixels, attrs, ink, paper, first, cells, scale);
+
+    // Остальные строки масштаба - копии первой
+    uint32_t *line = first + stride;
+    for (int s = 1; s < scale; s++, line += stride)
+        std::memcpy(line, first, sizeof(uint32_t) * cells * 8 * scale);
+}
@@ -0,0 +1,77 @@
+#ifndef SCREENDECODER_H
+#define SCREENDECODER_H
+
+#include <cstdint>
+
+// Разворачивает экран Спектрума (6144 байта точек + 768 атрибутов)
+// в 32-битный буфер 0xAARRGGBB, 256x192, по готовым таблицам:
+// адрес начала каждой строки в видеопамяти и цвета ink/paper для
+// каждого из 256 атрибутов с учётом мигания. Без Qt: буфер можно
+// отдать в QImage, в текстуру или посчитать от него хэш.
+//
+// Строка знакомест разворачивается векторным ядром (SSE2, AVX2, NEON),
+// лучшее из доступных выбирается при запуске по CPUID; на остальных
+// процессорах - скалярный цикл. Масштабы 1, 2 и 4 развёрнуты в ядрах,
+// прочие считаются скалярно.
+class ScreenDecoder
+{
+public:
+    static constexpr int WIDTH = 256;
+    static constexpr int HEIGHT = 192;
+    static constexpr int PIXELS_SIZE = WIDTH * HEIGHT / 8;
+    static constexpr int ATTR_WIDTH = WIDTH / 8;
+    static constexpr int ATTR_HEIGHT = HEIGHT / 8;
+
+    enum Kernel {
+        KERNEL_SCALAR = 0,
+        KERNEL_SSE2   = 1,
+        KERNEL_AVX2   = 2,
+        KERNEL_NEON   = 3
+    };
+
+    ScreenDecoder();
+
+    // 16 цветов: 0-7 обычные, 8-15 яркие
+    void set_palette(const uint32_t palette[16]);
+
+    // Лучшее ядро для этого процессора; set_kernel - для сравнения ядер,
+    // недоступное ядро заменяется скалярным
+    static Kernel best_kernel();
+    static bool kernel_supported(Kernel kernel);
+    static const char * kernel_name(Kernel kernel);
+    void set_kernel(Kernel kernel);
+    Kernel kernel() const { return _kernel; }
+
+    // Выход - (WIDTH * scale) x (HEIGHT * scale), stride - длина
+    // строки out в пикселях
+    void decode(const uint8_t *vram, bool flash, uint32_t *out, int stride,
+                int scale = 1) const;
+
+    // Только знакоместа, отмеченные в dirty (бит x слова y - знакоместо
+    // (x, y)), поверх уже развёрнутого в том же масштабе out
+    void decode_dirty(const uint8_t *vram, bool flash, uint32_t *out, int stride,
+                      int scale, const uint32_t dirty[ATTR_HEIGHT]) const;
+
+    // Добавляет в dirty мигающие знакоместа: их надо перерисовать при
+    // смене фазы мигания
+    static void mark_flash(const uint8_t *vram, uint32_t dirty[ATTR_HEIGHT]);
+
+    // Развёртка cells знакомест строки в cells * 8 * scale точек
+    using RowKernel = void (*)(const uint8_t *pixels, const uint8_t *attrs,
+                               const uint32_t *ink, const uint32_t *paper,
+                               uint32_t *out, int cells);
+
+private:
+    // Строка точек y, знакоместа x .. x + cells - 1, со всеми строками масштаба
+    void decode_span(const uint8_t *vram, bool flash, uint32_t *out, int stride,
+                     int scale, int y, int x, int cells) const;
+
+    uint16_t _row_addr[HEIGHT];     // смещение строки y в области точек
+    uint16_t _attr_addr[HEIGHT];    // смещение строки атрибутов для y
+    uint32_t _ink[2][256] {};       // [фаза мигания][атрибут]
+    uint32_t _paper[2][256] {};
+    Kernel _kernel { KERNEL_SCALAR };
+    RowKernel _rows[3] {};          // масштабы 1, 2, 4
+};
+
+#endif // SCREENDECODER_H
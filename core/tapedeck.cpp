@@ -0,0 +1,150 @@
+#include "tapedeck.h"
+#include "tapimage.h"
+#include "tzximage.h"
+
+TapeDeck::TapeDeck(Scheduler &scheduler, Output output) :
+    _scheduler(scheduler),
+    _output(std::move(output))
+{
+}
+
+TapeDeck::~TapeDeck()
+{
+    close();
+}
+
+bool TapeDeck::open(const QString &filename)
+{
+    close();
+    _error.clear();
+    _file.setFileName(filename);
+    if (not _file.open(QIODevice::ReadOnly)) {
+        _error = QString("Can't open a tape: ") + filename;
+        return false;
+    }
+    qint64 size = _file.size();
+    _map = size > 0 ? _file.map(0, size) : nullptr;
+    if (not _map) {
+        _file.close();
+        _error = QString("Can't map a tape: ") + filename;
+        return false;
+    }
+
+    std::unique_ptr<TzxImage> tzx(new TzxImage);
+    std::unique_ptr<TapImage> tap(new TapImage);
+    if (tzx->open(_map, size))
+        _image = std::move(tzx);
+    else if (tap->open(_map, size))
+        _image = std::move(tap);
+    else {
+        close();
+        _error = QString("Not a .tap or .tzx tape: ") + filename;
+        return false;
+    }
+    _image->set_48k(_48k);
+    return true;
+}
+
+void TapeDeck::close()
+{
+    stop();
+    _image.reset();
+    if (_map)
+        _file.unmap(_map);
+    _map = nullptr;
+    _file.close();
+    _pulse = 0;
+}
+
+void TapeDeck::play()
+{
+    if (_playing or not _image)
+        return;
+    _image->set_cpu_hz(_scheduler.timing().cpu_hz);
+    _playing = true;
+    schedule(_scheduler.now());
+}
+
+void TapeDeck::stop()
+{
+    if (not _playing)
+        return;
+    _scheduler.cancel(_event);
+    _playing = false;
+}
+
+void TapeDeck::rewind()
+{
+    stop();
+    if (_image)
+        _image->rewind();
+    _pulse = 0;
+}
+
+bool TapeDeck::take_rom_block(const uint8_t *&data, uint32_t &size)
+{
+    if (not _image)
+        return false;
+    _image->set_cpu_hz(_scheduler.timing().cpu_hz);
+    bool taken = _image->take_rom_block(data, size);
+    // Взятый блок мог уже играть пилотом: следующий фронт - по новой
+    // позиции. Иначе игру не трогаем, чтобы не обрезать текущий импульс
+    if (taken)
+        stop();
+    play();
+    return taken;
+}
+
+void TapeDeck::set_48k(bool is_48k)
+{
+    _48k = is_48k;
+    if (_image)
+        _image->set_48k(is_48k);
+}
+
+void TapeDeck::restart()
+{
+    _output(_level);
+    if (_image)
+        _image->set_cpu_hz(_scheduler.timing().cpu_hz);
+    if (_playing)
+        schedule(_scheduler.now() + _pulse);
+}
+
+void TapeDeck::schedule(uint64_t when)
+{
+    _event = _scheduler.schedule(when, [this](uint64_t at) { edge(at); });
+}
+
+// Начало импульса: выставить уровень и поставить событие на его конец.
+// Следующий фронт считается от метки события, а не от now(), чтобы
+// задержка до границы инструкции не копилась. Импульсы нулевой длины
+// (смена уровня блоком) применяются сразу
+void TapeDeck::edge(uint64_t when)
+{
+    bool level = _level;
+    TapePulse pulse;
+    do {
+        TapeImage::Result result = _image->next(pulse);
+        if (result != TapeImage::PULSE) {
+            _playing = false;       // лента кончилась или блок остановил её
+            _pulse = 0;
+            break;
+        }
+        switch (pulse.edge) {
+        case TapePulse::TOGGLE: level = not level; break;
+        case TapePulse::KEEP:   break;
+        case TapePulse::LOW:    level = false; break;
+        case TapePulse::HIGH:   level = true; break;
+        }
+    } while (pulse.length == 0);
+
+    if (level != _level) {
+        _level = level;
+        _output(level);
+    }
+    if (_playing) {
+        _pulse = pulse.length;
+        schedule(when + pulse.length);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef TAPEDECK_H
+#define TAPEDECK_H
+
+#include <QFile>
+#include <QString>
+#include <functional>
+#include <memory>
+#include "scheduler.h"
+#include "tapeimage.h"
+
+// Магнитофон: образ ленты (.tap или .tzx, TapImage/TzxImage)
+// отображается в память (QFile::map) и проигрывается в EAR без
+// развёртки в импульсы. Каждый фронт - событие планировщика: в нём
+// уровень меняется, образ отдаёт длину следующего импульса и ставится
+// следующее событие. Состояние - несколько счётчиков, поэтому память
+// не зависит от длины ленты.
+class TapeDeck
+{
+public:
+    // output получает уровень EAR при каждой его смене
+    using Output = std::function<void (bool level)>;
+
+    TapeDeck(Scheduler &scheduler, Output output);
+    TapeDeck(const TapeDeck &) = delete;
+    TapeDeck & operator=(const TapeDeck &) = delete;
+    ~TapeDeck();
+
+    // Вставить ленту (перемотанной в начало), формат - по сигнатуре.
+    // false - причина в error()
+    bool open(const QString &filename);
+    void close();
+    bool loaded() const { return _image != nullptr; }
+    QString filename() const { return _file.fileName(); }
+    const QString & error() const { return _error; }
+
+    void play();
+    void stop();
+    void rewind();
+    bool playing() const { return _playing; }
+
+    // Номер текущего блока и число блоков
+    int block() const { return _image ? _image->block() : 0; }
+    int blocks() const { return _image ? _image->blocks() : 0; }
+
+    // Ловушка LD-BYTES (Machine): данные следующего блока в кодировке
+    // ПЗУ, лента переходит за него. После вызова лента играет: блок,
+    // который ловушка не взяла, загрузчик получит настоящими импульсами
+    bool take_rom_block(const uint8_t *&data, uint32_t &size);
+
+    // Модель 48К: блок TZX 2Ah останавливает ленту
+    void set_48k(bool is_48k);
+
+    // Планировщик очищен (сброс, смена модели): продолжить с места
+    // остановки и выставить уровень EAR на новой шине
+    void restart();
+
+private:
+    void schedule(uint64_t when);
+    void edge(uint64_t when);
+
+    Scheduler &_scheduler;
+    Output _output;
+    QFile _file;
+    uchar *_map { nullptr };
+    std::unique_ptr<TapeImage> _image;
+    bool _48k { false };
+    QString _error;
+
+    uint32_t _pulse { 0 };      // длина текущего импульса
+    bool _level { false };
+    bool _playing { false };
+    uint64_t _event { 0 };
+};
+
+#endif // TAPEDECK_H
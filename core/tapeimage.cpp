@@ -0,0 +1,106 @@
+#include "tapeimage.h"
+
+void TapeImage::start_pause(uint32_t ms)
+{
+    _pause_left = uint32_t(uint64_t(_cpu_hz) * ms / 1000);
+    _pause_edge = true;
+}
+
+bool TapeImage::pause_pulse(TapePulse &pulse)
+{
+    if (_pause_left == 0)
+        return false;
+    if (_pause_edge) {
+        _pause_edge = false;
+        uint32_t edge = _cpu_hz / 1000;
+        if (edge < _pause_left) {
+            _pause_left -= edge;
+            pulse = { TapePulse::TOGGLE, edge };
+            return true;
+        }
+        pulse = { TapePulse::TOGGLE, _pause_left };
+    } else {
+        pulse = { TapePulse::LOW, _pause_left };
+    }
+    _pause_left = 0;
+    return true;
+}
+
+void TapeData::set_standard(const uint8_t *data, uint32_t size)
+{
+    pilot_pulse = PILOT_PULSE;
+    sync1_pulse = SYNC1_PULSE;
+    sync2_pulse = SYNC2_PULSE;
+    zero_pulse = ZERO_PULSE;
+    one_pulse = ONE_PULSE;
+    pilot_pulses = size > 0 and data[0] < 128 ? HEADER_PILOT : DATA_PILOT;
+    sync = true;
+}
+
+// LD-EDGE меряет импульсы с шагом 59 тактов, порог бита - середина между
+// нулём и единицей: 1/8 от стандарта он ещё различает
+static bool near(uint32_t value, uint32_t standard)
+{
+    uint32_t delta = value > standard ? value - standard : standard - value;
+    return delta <= standard / 8;
+}
+
+bool TapeData::rom_loadable() const
+{
+    return sync and _last_bits == 8
+        and near(pilot_pulse, PILOT_PULSE) and near(sync1_pulse, SYNC1_PULSE)
+        and near(sync2_pulse, SYNC2_PULSE) and near(zero_pulse, ZERO_PULSE)
+        and near(one_pulse, ONE_PULSE);
+}
+
+void TapeData::start(const uint8_t *data, uint32_t size, int last_bits)
+{
+    _data = data;
+    _size = size;
+    _last_bits = last_bits < 1 or last_bits > 8 ? 8 : last_bits;
+    _pulses = pilot_pulses;
+    _pos = 0;
+    _bit = 0;
+    _second_half = false;
+    _state = PILOT;
+}
+
+bool TapeData::next(TapePulse &pulse)
+{
+    for (;;) {
+        switch (_state) {
+        case PILOT:
+            if (_pulses > 0) {
+                _pulses--;
+                pulse = { TapePulse::TOGGLE, pilot_pulse };
+                return true;
+            }
+            _state = sync ? SYNC1 : DATA;
+            continue;
+        case SYNC1:
+            _state = SYNC2;
+            pulse = { TapePulse::TOGGLE, sync1_pulse };
+            return true;
+        case SYNC2:
+            _state = DATA;
+            pulse = { TapePulse::TOGGLE, sync2_pulse };
+            return true;
+        case DATA: {
+            if (_pos >= _size or (_pos + 1 == _size and _bit >= _last_bits)) {
+                _state = DONE;
+                continue;
+            }
+            bool one = _data[_pos] & (0x80 >> _bit);
+            pulse = { TapePulse::TOGGLE, one ? one_pulse : zero_pulse };
+            _second_half = not _second_half;
+            if (not _second_half and ++_bit == 8) {
+                _bit = 0;
+                _pos++;
+            }
+            return true;
+        }
+        case DONE:
+            return false;
+        }
+    }
+}
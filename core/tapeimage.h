@@ -0,0 +1,110 @@
+#ifndef TAPEIMAGE_H
+#define TAPEIMAGE_H
+
+#include <cstdint>
+
+// Импульс ленты: что сделать с уровнем EAR в его начале и сколько он
+// длится в тактах CPU. Импульс нулевой длины только меняет уровень
+struct TapePulse
+{
+    enum Edge { TOGGLE, KEEP, LOW, HIGH };
+
+    Edge edge { TOGGLE };
+    uint32_t length { 0 };
+};
+
+// Образ ленты, отображённый в память (TapeDeck): разбирает блоки на
+// месте и отдаёт импульсы по одному. Длительности в форматах заданы
+// в тактах, паузы в мс переводятся по частоте CPU модели
+class TapeImage
+{
+public:
+    enum Result {
+        PULSE,      // импульс в pulse
+        STOP,       // блок останавливает магнитофон, play() продолжит
+        END         // лента кончилась
+    };
+
+    virtual ~TapeImage() = default;
+
+    virtual Result next(TapePulse &pulse) = 0;
+    virtual void rewind() = 0;
+    virtual int block() const = 0;
+    virtual int blocks() const = 0;
+
+    // Ловушка LD-BYTES: отдать данные следующего блока в кодировке ПЗУ
+    // и перейти за него. Блок, у которого уже пошли синхроимпульсы или
+    // данные, не отдаётся. false - впереди блок в другой кодировке,
+    // остановка или конец ленты; позиция тогда не меняется
+    virtual bool take_rom_block(const uint8_t *&data, uint32_t &size) = 0;
+
+    void set_cpu_hz(uint32_t hz) { _cpu_hz = hz; }
+    // Модель 48К: для блока TZX "Stop the tape if in 48K mode"
+    void set_48k(bool is_48k) { _48k = is_48k; }
+
+protected:
+    // Пауза после блока: фронт, закрывающий последний импульс, 1 мс
+    // противоположного уровня, остаток - низкий уровень
+    void start_pause(uint32_t ms);
+    bool pause_pulse(TapePulse &pulse);
+
+    uint32_t _cpu_hz { 3500000 };
+    bool _48k { false };
+
+private:
+    uint32_t _pause_left { 0 };
+    bool _pause_edge { false };
+};
+
+// Блок в кодировке ПЗУ: пилот, два синхроимпульса, биты по два
+// одинаковых импульса, старший первым. Общий для TAP и блоков TZX
+// 10h, 11h и 14h; данные читаются прямо из образа
+class TapeData
+{
+public:
+    static constexpr uint32_t PILOT_PULSE = 2168;
+    static constexpr uint32_t SYNC1_PULSE = 667;
+    static constexpr uint32_t SYNC2_PULSE = 735;
+    static constexpr uint32_t ZERO_PULSE = 855;
+    static constexpr uint32_t ONE_PULSE = 1710;
+    static constexpr int HEADER_PILOT = 8063;   // импульсов у заголовка (флаг < 128)
+    static constexpr int DATA_PILOT = 3223;
+
+    uint32_t pilot_pulse { PILOT_PULSE };
+    uint32_t sync1_pulse { SYNC1_PULSE };
+    uint32_t sync2_pulse { SYNC2_PULSE };
+    uint32_t zero_pulse { ZERO_PULSE };
+    uint32_t one_pulse { ONE_PULSE };
+    int pilot_pulses { 0 };
+    bool sync { true };                         // нет у чистых данных (14h)
+
+    // Стандартные длительности, пилот по флагу - первому байту
+    void set_standard(const uint8_t *data, uint32_t size);
+
+    // Начать блок: size байт, в последнем используется last_bits старших
+    void start(const uint8_t *data, uint32_t size, int last_bits = 8);
+    // false - блок кончился
+    bool next(TapePulse &pulse);
+
+    // Блок ещё в пилоте (или не начат) и читается LD-BYTES: длительности
+    // стандартные с допуском загрузчика ПЗУ, последний байт полный
+    bool in_pilot() const { return _state == PILOT; }
+    bool rom_loadable() const;
+    const uint8_t * data() const { return _data; }
+    uint32_t size() const { return _size; }
+
+private:
+    enum State { PILOT, SYNC1, SYNC2, DATA, DONE };
+
+    const uint8_t *_data { nullptr };
+    uint32_t _size { 0 };
+    int _last_bits { 8 };
+
+    State _state { DONE };
+    int _pulses { 0 };
+    uint32_t _pos { 0 };
+    int _bit { 0 };             // 0 - старший бит байта _pos
+    bool _second_half { false };
+};
+
+#endif // TAPEIMAGE_H
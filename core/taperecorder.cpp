@@ -0,0 +1,288 @@
+#include "taperecorder.h"
+#include "tapeimage.h"
+#include <algorithm>
+
+static void put16(QByteArray &out, uint32_t value)
+{
+    out.append(char(value & 0xFF));
+    out.append(char((value >> 8) & 0xFF));
+}
+
+static void put24(QByteArray &out, uint32_t value)
+{
+    put16(out, value & 0xFFFF);
+    out.append(char((value >> 16) & 0xFF));
+}
+
+static void put32(QByteArray &out, uint32_t value)
+{
+    put16(out, value & 0xFFFF);
+    put16(out, value >> 16);
+}
+
+// Импульсы потока по одному; false - поток кончился
+static bool take_pulse(const QByteArray &stream, int &pos, uint32_t &cycles)
+{
+    cycles = 0;
+    for (int shift = 0; pos < stream.size(); shift += 7) {
+        uint8_t byte = uint8_t(stream[pos++]);
+        cycles |= uint32_t(byte & 0x7F) << shift;
+        if (not (byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// RLE CSW: импульс в сэмплах байтом, длиннее 255 - ноль и 32 бита.
+// Время копится в тактах, чтобы округление не уводило частоту;
+// импульс короче сэмпла растягивается до одного
+static void put_csw(QByteArray &out, uint64_t &cycles, uint64_t &samples,
+                    uint32_t pulse, uint32_t cpu_hz)
+{
+    cycles += pulse;
+    uint64_t end = (cycles * TapeRecorder::CSW_RATE + cpu_hz / 2) / cpu_hz;
+    uint64_t length = end > samples ? end - samples : 1;
+    samples += length;
+    if (length <= 0xFF)
+        out.append(char(length));
+    else {
+        out.append(char(0));
+        put32(out, uint32_t(std::min<uint64_t>(length, UINT32_MAX)));
+    }
+}
+
+bool TapeRecorder::open(const QString &filename, uint32_t cpu_hz)
+{
+    close();
+    _error.clear();
+    _cpu_hz = cpu_hz;
+    _blocks = 0;
+    _burst = false;
+
+    QString suffix = filename.section('.', -1).toLower();
+    QByteArray header;
+    if (suffix == "tzx") {
+        _format = TZX;
+        header = QByteArray("ZXTape!\x1A", 8);
+        header.append(char(1));
+        header.append(char(20));
+    } else if (suffix == "csw") {
+        // CSW 1.01: частота, RLE, начальный уровень низкий
+        _format = CSW;
+        header = QByteArray("Compressed Square Wave\x1A", 23);
+        header.append(char(1));
+        header.append(char(1));
+        put16(header, CSW_RATE);
+        header.append(char(1));
+        header.append(char(0));
+        header.append(QByteArray(3, 0));
+    } else
+        _format = TAP;
+
+    if (not _writer.open(filename, header)) {
+        _error = _writer.error();
+        return false;
+    }
+    _recording = true;
+    return true;
+}
+
+bool TapeRecorder::close()
+{
+    if (not _recording)
+        return true;
+    if (_burst)
+        end_burst(ms_cycles(_format == TZX ? TAIL_MS : SILENCE_MS), SILENCE_MS);
+    _writer.finish();
+    _recording = false;
+    if (not _writer.error().isEmpty())
+        _error = _writer.error();
+    return _error.isEmpty();
+}
+
+QString TapeRecorder::error() const
+{
+    if (_recording and not _writer.error().isEmpty())
+        return _writer.error();
+    return _error;
+}
+
+void TapeRecorder::lose_block(const QString &error)
+{
+    if (_recording and _error.isEmpty())
+        _error = error;
+}
+
+void TapeRecorder::rom_block(const QByteArray &block)
+{
+    if (not _recording)
+        return;
+    if (_burst)
+        end_burst(ms_cycles(_format == TZX ? TAIL_MS : SILENCE_MS), SILENCE_MS);
+
+    uint32_t cpu_hz = _cpu_hz;
+    Format format = _format;
+    _writer.post([block, format, cpu_hz] {
+        QByteArray out;
+        switch (format) {
+        case TAP:
+            put16(out, uint32_t(block.size()));
+            out.append(block);
+            break;
+        case TZX:
+            out.append(char(0x10));
+            put16(out, BLOCK_PAUSE_MS);
+            put16(out, uint32_t(block.size()));
+            out.append(block);
+            break;
+        case CSW:
+            out = encode_rom_csw(block, cpu_hz);
+            break;
+        }
+        return out;
+    });
+    _blocks++;
+}
+
+void TapeRecorder::edge(uint64_t when, bool level)
+{
+    if (not records_edges())
+        return;
+    if (not _burst) {
+        _burst = true;
+        _stream.clear();
+        _first_level = level;
+        _level = level;
+        _burst_start = when;
+        _last_edge = when;
+        return;
+    }
+    if (level == _level)
+        return;
+    put_pulse(_stream, uint32_t(std::min<uint64_t>(when - _last_edge, UINT32_MAX)));
+    _last_edge = when;
+    _level = level;
+
+    // Длинная запись уходит частями: новая часть начинается с этого фронта
+    if (_stream.size() >= MAX_BURST_BYTES or when - _burst_start >= ms_cycles(MAX_BURST_MS)) {
+        end_burst(0, 0);
+        edge(when, level);
+    }
+}
+
+void TapeRecorder::update(uint64_t now)
+{
+    if (_burst and now - _last_edge >= ms_cycles(SILENCE_MS))
+        end_burst(ms_cycles(_format == TZX ? TAIL_MS : SILENCE_MS), SILENCE_MS);
+}
+
+void TapeRecorder::restart(uint32_t cpu_hz)
+{
+    if (_burst)
+        end_burst(ms_cycles(_format == TZX ? TAIL_MS : SILENCE_MS), SILENCE_MS);
+    _cpu_hz = cpu_hz;
+}
+
+// Запись фронтов - в файл. tail - импульс после последнего фронта
+// (0 - без него), pause_ms - пауза после блока 15h
+void TapeRecorder::end_burst(uint32_t tail, uint32_t pause_ms)
+{
+    _burst = false;
+    if (tail)
+        put_pulse(_stream, tail);
+    if (_stream.isEmpty())
+        return;
+
+    QByteArray stream = _stream;
+    _stream.clear();
+    bool level = _first_level;
+    uint32_t cpu_hz = _cpu_hz;
+    if (_format == TZX)
+        _writer.post([stream, level, pause_ms] { return encode_direct(stream, level, uint16_t(pause_ms)); });
+    else
+        _writer.post([stream, cpu_hz] { return encode_csw(stream, cpu_hz); });
+    _blocks++;
+}
+
+void TapeRecorder::put_pulse(QByteArray &stream, uint32_t cycles)
+{
+    do {
+        uint8_t byte = cycles & 0x7F;
+        cycles >>= 7;
+        stream.append(char(cycles ? byte | 0x80 : byte));
+    } while (cycles);
+}
+
+// Блок 15h: уровень каждого сэмпла битом, старший первым. Границы
+// импульсов округляются до сэмпла от начала блока; импульс короче
+// сэмпла пропадает, уровни следующих от этого не сбиваются
+QByteArray TapeRecorder::encode_direct(const QByteArray &stream, bool level, uint16_t pause_ms)
+{
+    QByteArray samples;
+    uint8_t byte = 0;
+    int bits = 0;
+    uint64_t cycles = 0;
+    uint64_t done = 0;
+    int pos = 0;
+    uint32_t pulse;
+    while (take_pulse(stream, pos, pulse)) {
+        cycles += pulse;
+        uint64_t end = (cycles + TZX_SAMPLE_CYCLES / 2) / TZX_SAMPLE_CYCLES;
+        for (; done < end; done++) {
+            byte = uint8_t(byte << 1 | (level ? 1 : 0));
+            if (++bits == 8) {
+                samples.append(char(byte));
+                byte = 0;
+                bits = 0;
+            }
+        }
+        level = not level;
+    }
+    int last_bits = 8;
+    if (bits) {
+        samples.append(char(byte << (8 - bits)));
+        last_bits = bits;
+    }
+    if (samples.isEmpty())
+        return QByteArray();
+
+    QByteArray out;
+    out.append(char(0x15));
+    put16(out, TZX_SAMPLE_CYCLES);
+    put16(out, pause_ms);
+    out.append(char(last_bits));
+    put24(out, uint32_t(samples.size()));
+    out.append(samples);
+    return out;
+}
+
+QByteArray TapeRecorder::encode_csw(const QByteArray &stream, uint32_t cpu_hz)
+{
+    QByteArray out;
+    uint64_t cycles = 0;
+    uint64_t samples = 0;
+    int pos = 0;
+    uint32_t pulse;
+    while (take_pulse(stream, pos, pulse))
+        put_csw(out, cycles, samples, pulse, cpu_hz);
+    return out;
+}
+
+// Блок ловушки в CSW: импульсы ПЗУ (TapeData) и пауза одним импульсом
+QByteArray TapeRecorder::encode_rom_csw(const QByteArray &block, uint32_t cpu_hz)
+{
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(block.constData());
+    uint32_t size = uint32_t(block.size());
+    TapeData tape;
+    tape.set_standard(data, size);
+    tape.start(data, size);
+
+    QByteArray out;
+    uint64_t cycles = 0;
+    uint64_t samples = 0;
+    TapePulse pulse;
+    while (tape.next(pulse))
+        put_csw(out, cycles, samples, pulse.length, cpu_hz);
+    put_csw(out, cycles, samples, uint32_t(uint64_t(cpu_hz) * BLOCK_PAUSE_MS / 1000), cpu_hz);
+    return out;
+}
@@ -0,0 +1,88 @@
+#ifndef TAPERECORDER_H
+#define TAPERECORDER_H
+
+#include <QByteArray>
+#include <QString>
+#include "tapewriter.h"
+
+// Запись ленты в файл. Два пути:
+//  - блок из ловушки SA-BYTES (Machine): байты блока прямо из памяти,
+//    в .tap и .tzx (10h) как есть, в .csw - импульсами ПЗУ;
+//  - фронты выхода MIC (бит 3 порта FE) от любого другого записывающего
+//    кода: разности времён фронтов копятся в компактном потоке (LEB128,
+//    обычно байт-два на импульс) и после SILENCE_MS тишины уходят в файл
+//    блоком прямой записи TZX 15h или импульсами CSW. В .tap фронты
+//    не пишутся.
+// Кодирование и запись - в потоке TapeWriter, в кадре только копятся
+// байты потока.
+class TapeRecorder
+{
+public:
+    enum Format { TAP, TZX, CSW };
+
+    static constexpr uint32_t SILENCE_MS = 1000;    // тишина на MIC, закрывающая запись
+    static constexpr uint32_t BLOCK_PAUSE_MS = 1000;
+    static constexpr uint32_t TAIL_MS = 1;          // последний импульс 15h перед паузой
+    static constexpr int MAX_BURST_BYTES = 1 << 20; // поток, после которого он уходит в файл
+    static constexpr uint32_t MAX_BURST_MS = 60000;
+    static constexpr uint16_t TZX_SAMPLE_CYCLES = 79;   // 15h: ~44,3 кГц
+    static constexpr uint16_t CSW_RATE = 44100;
+
+    TapeRecorder() = default;
+    TapeRecorder(const TapeRecorder &) = delete;
+    TapeRecorder & operator=(const TapeRecorder &) = delete;
+    ~TapeRecorder() { close(); }
+
+    // Начать запись в новый файл, формат - по расширению (.tzx, .csw,
+    // остальное - .tap). false - причина в error()
+    bool open(const QString &filename, uint32_t cpu_hz);
+    // Дописать начатое и закрыть файл (ждёт поток записи).
+    // false - что-то не записалось или блок потерян, причина в error()
+    bool close();
+    bool recording() const { return _recording; }
+    Format format() const { return _format; }
+    bool records_edges() const { return _recording and _format != TAP; }
+    QString filename() const { return _writer.filename(); }
+    QString error() const;
+    int blocks() const { return _blocks; }
+
+    // Блок в кодировке ПЗУ: флаг, данные и контрольная сумма
+    void rom_block(const QByteArray &block);
+    // Блок, который в файл не попадёт: запись кончится ошибкой error
+    void lose_block(const QString &error);
+    // Смена уровня MIC в такт when
+    void edge(uint64_t when, bool level);
+    // Конец кадра: закрыть запись фронтов после тишины
+    void update(uint64_t now);
+
+    // Планировщик очищен, часы пошли с нуля: начатая запись фронтов
+    // закрывается, как после тишины
+    void restart(uint32_t cpu_hz);
+
+private:
+    void end_burst(uint32_t tail, uint32_t pause_ms);
+    uint32_t ms_cycles(uint32_t ms) const { return uint32_t(uint64_t(_cpu_hz) * ms / 1000); }
+
+    static void put_pulse(QByteArray &stream, uint32_t cycles);
+    static QByteArray encode_direct(const QByteArray &stream, bool level, uint16_t pause_ms);
+    static QByteArray encode_csw(const QByteArray &stream, uint32_t cpu_hz);
+    static QByteArray encode_rom_csw(const QByteArray &block, uint32_t cpu_hz);
+
+    TapeWriter _writer;
+    Format _format { TAP };
+    bool _recording { false };
+    uint32_t _cpu_hz { 3500000 };
+    int _blocks { 0 };
+    QString _error;
+
+    // Текущая запись фронтов: длины импульсов в тактах, первый - с
+    // уровнем _first_level, дальше уровни чередуются
+    bool _burst { false };
+    QByteArray _stream;
+    bool _first_level { false };
+    bool _level { false };          // уровень после последнего фронта
+    uint64_t _burst_start { 0 };
+    uint64_t _last_edge { 0 };
+};
+
+#endif // TAPERECORDER_H
@@ -0,0 +1,79 @@
+#include "tapewriter.h"
+#include <QMutexLocker>
+
+TapeWriter::~TapeWriter()
+{
+    finish();
+}
+
+bool TapeWriter::open(const QString &filename, const QByteArray &header)
+{
+    finish();
+    _error.clear();
+    _finish = false;
+    _file.setFileName(filename);
+    if (not _file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        _error = QString("Can't create a tape: ") + filename;
+        return false;
+    }
+    if (_file.write(header) != header.size()) {
+        _file.close();
+        _error = QString("Can't write a tape: ") + filename;
+        return false;
+    }
+    start(QThread::LowPriority);
+    return true;
+}
+
+void TapeWriter::post(Job job)
+{
+    QMutexLocker lock(&_mutex);
+    _jobs.push_back(std::move(job));
+    _wake.wakeOne();
+}
+
+void TapeWriter::finish()
+{
+    if (not isRunning())
+        return;
+    {
+        QMutexLocker lock(&_mutex);
+        _finish = true;
+        _wake.wakeOne();
+    }
+    wait();
+    _file.close();
+}
+
+QString TapeWriter::error() const
+{
+    QMutexLocker lock(&_mutex);
+    return _error;
+}
+
+// Очередь разбирается до конца и после finish(): закрытие не теряет
+// записанного. После ошибки задания только выбрасываются
+void TapeWriter::run()
+{
+    QMutexLocker lock(&_mutex);
+    for (;;) {
+        while (_jobs.empty() and not _finish)
+            _wake.wait(&_mutex);
+        if (_jobs.empty())
+            break;
+        Job job = std::move(_jobs.front());
+        _jobs.pop_front();
+        bool failed = not _error.isEmpty();
+        lock.unlock();
+
+        if (not failed) {
+            QByteArray bytes = job();
+            if (_file.write(bytes) != bytes.size() or not _file.flush()) {
+                lock.relock();
+                _error = QString("Can't write a tape: ") + _file.fileName();
+                continue;
+            }
+        }
+        lock.relock();
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef TAPEWRITER_H
+#define TAPEWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <deque>
+#include <functional>
+
+// Поток записи ленты (TapeRecorder): задания из очереди кодируются и
+// дописываются в файл в своём потоке, так что ни кодирование, ни диск
+// не задерживают кадры. post() только кладёт задание в очередь под
+// мьютексом. Файл только дописывается, заголовок пишется при открытии
+class TapeWriter : public QThread
+{
+public:
+    // Задание: возвращает байты, которые допишутся в конец файла
+    using Job = std::function<QByteArray ()>;
+
+    TapeWriter() = default;
+    TapeWriter(const TapeWriter &) = delete;
+    TapeWriter & operator=(const TapeWriter &) = delete;
+    ~TapeWriter() override;
+
+    // Создать файл с заголовком и запустить поток. false - причина в error()
+    bool open(const QString &filename, const QByteArray &header);
+    void post(Job job);
+    // Дождаться записи всех заданий и закрыть файл
+    void finish();
+
+    QString filename() const { return _file.fileName(); }
+    // Первая ошибка записи; читается из любого потока
+    QString error() const;
+
+protected:
+    void run() override;
+
+private:
+    QFile _file;
+    mutable QMutex _mutex;          // _jobs, _finish, _error
+    QWaitCondition _wake;
+    std::deque<Job> _jobs;
+    bool _finish { false };
+    QString _error;
+};
+
+#endif // TAPEWRITER_H
@@ -0,0 +1,95 @@
+#include "tapimage.h"
+#include <algorithm>
+#include <Z/formats/storage medium image/audio/TAP.h>
+#include <Z/macros/value.h>
+
+bool TapImage::open(const uint8_t *data, int64_t size)
+{
+    _data = data;
+    _size = size;
+    _blocks = 0;
+    for (int64_t offset = 0; offset + int64_t(sizeof(ZTAPBlock)) <= _size; _blocks++)
+        offset += int64_t(sizeof(ZTAPBlock)) + block_size(offset);
+    rewind();
+    return _blocks > 0;
+}
+
+// Длина блока по смещению его заголовка; обрезанный конец файла - до конца
+int64_t TapImage::block_size(int64_t offset) const
+{
+    const ZTAPBlock *block = reinterpret_cast<const ZTAPBlock *>(_data + offset);
+    int64_t length = Z_16BIT_LITTLE_ENDIAN(block->size);
+    return std::min(length, _size - offset - int64_t(sizeof(ZTAPBlock)));
+}
+
+void TapImage::rewind()
+{
+    _state = BLOCK;
+    _next_block = 0;
+    _block = 0;
+}
+
+// Следующий непустой блок - в _block_data; false - блоков больше нет
+bool TapImage::start_block()
+{
+    for (;;) {
+        if (_next_block + int64_t(sizeof(ZTAPBlock)) > _size)
+            return false;
+        int64_t length = block_size(_next_block);
+        const uint8_t *data = _data + _next_block + sizeof(ZTAPBlock);
+        _next_block += int64_t(sizeof(ZTAPBlock)) + length;
+        if (length == 0) {
+            _block++;
+            continue;
+        }
+        _block_data.set_standard(data, uint32_t(length));
+        _block_data.start(data, uint32_t(length));
+        _state = DATA;
+        return true;
+    }
+}
+
+TapeImage::Result TapImage::next(TapePulse &pulse)
+{
+    for (;;) {
+        switch (_state) {
+        case BLOCK:
+            if (not start_block())
+                return END;
+            continue;
+        case DATA:
+            if (_block_data.next(pulse))
+                return PULSE;
+            _block++;
+            // После последнего блока паузы нет: лента просто кончается
+            if (_next_block + int64_t(sizeof(ZTAPBlock)) > _size) {
+                _state = BLOCK;
+                pulse = { TapePulse::TOGGLE, 0 };
+                return PULSE;
+            }
+            start_pause(PAUSE_MS);
+            _state = PAUSE;
+            continue;
+        case PAUSE:
+            if (pause_pulse(pulse))
+                return PULSE;
+            _state = BLOCK;
+            continue;
+        }
+    }
+}
+
+// Все блоки TAP в кодировке ПЗУ: отдаётся текущий, если он ещё в пилоте,
+// иначе следующий; остаток паузы пропускается
+bool TapImage::take_rom_block(const uint8_t *&data, uint32_t &size)
+{
+    if (_state == DATA and not _block_data.in_pilot())
+        return false;
+    if (_state != DATA and not start_block())
+        return false;
+    data = _block_data.data();
+    size = _block_data.size();
+    _block++;
+    _state = BLOCK;
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef TAPIMAGE_H
+#define TAPIMAGE_H
+
+#include "tapeimage.h"
+
+// Образ .tap: блоки ZTAPBlock (Z, TAP.h) подряд, каждый пишется как
+// у ПЗУ (SA-BYTES) с паузой в секунду
+class TapImage : public TapeImage
+{
+public:
+    static constexpr int PAUSE_MS = 1000;
+
+    // false - в образе нет ни одного блока
+    bool open(const uint8_t *data, int64_t size);
+
+    Result next(TapePulse &pulse) override;
+    void rewind() override;
+    int block() const override { return _block; }
+    int blocks() const override { return _blocks; }
+    bool take_rom_block(const uint8_t *&data, uint32_t &size) override;
+
+private:
+    enum State { BLOCK, DATA, PAUSE };
+
+    int64_t block_size(int64_t offset) const;
+    bool start_block();
+
+    const uint8_t *_data { nullptr };
+    int64_t _size { 0 };
+    int _blocks { 0 };
+
+    State _state { BLOCK };
+    int64_t _next_block { 0 };  // смещение заголовка следующего блока
+    int _block { 0 };
+    TapeData _block_data;
+};
+
+#endif // TAPIMAGE_H
@@ -0,0 +1,562 @@
+#include "tzximage.h"
+#include <algorithm>
+#include <cstring>
+#include <Z/formats/storage medium image/audio/TZX.h>
+#include <Z/macros/value.h>
+
+// Члены данных (Z_FLEXIBLE_ARRAY_MEMBER) в C++ не объявляются:
+// данные блока идут сразу за sizeof() его заголовка
+
+static uint32_t read16(const uint8_t *p)
+{
+    return uint32_t(p[0] | p[1] << 8);
+}
+
+static uint32_t read24(const uint8_t *p)
+{
+    return uint32_t(p[0] | p[1] << 8 | p[2] << 16);
+}
+
+static uint32_t read32(const uint8_t *p)
+{
+    return read24(p) | uint32_t(p[3]) << 24;
+}
+
+bool TzxImage::open(const uint8_t *data, int64_t size)
+{
+    _data = data;
+    _size = size;
+    _index.clear();
+
+    const ZTZXHeader *header = reinterpret_cast<const ZTZXHeader *>(data);
+    if (size < int64_t(sizeof(ZTZXHeader)) or
+        std::memcmp(header->signature, "ZXTape!", 7) != 0 or header->eof_marker != 0x1A)
+        return false;
+
+    // Обрезанный последний блок отбрасывается
+    for (int64_t offset = sizeof(ZTZXHeader); offset < size; ) {
+        int64_t length = block_size(data, size, offset);
+        if (length < 0)
+            break;
+        _index.push_back(offset);
+        offset += length;
+    }
+    rewind();
+    return not _index.empty();
+}
+
+int64_t TzxImage::block_size(const uint8_t *data, int64_t size, int64_t offset)
+{
+    const uint8_t *p = data + offset + 1;
+    int64_t left = size - offset - 1;
+    int64_t header;                 // сколько нужно прочесть для длины
+    int64_t length;
+
+    switch (data[offset]) {
+    case Z_TZX_BLOCK_ID_STANDARD_SPEED_DATA: header = 4; break;
+    case Z_TZX_BLOCK_ID_TURBO_SPEED_DATA:    header = sizeof(ZTZXTurboSpeedData); break;
+    case Z_TZX_BLOCK_ID_PURE_TONE:           header = 4; break;
+    case Z_TZX_BLOCK_ID_PULSE_SEQUENCE:      header = 1; break;
+    case Z_TZX_BLOCK_ID_PURE_DATA:           header = sizeof(ZTZXPureData); break;
+    case Z_TZX_BLOCK_ID_DIRECT_RECORDING:    header = sizeof(ZTZXDirectRecording); break;
+    case Z_TZX_BLOCK_ID_PAUSE:               header = 2; break;
+    case Z_TZX_BLOCK_ID_GROUP_START:         header = 1; break;
+    case Z_TZX_BLOCK_ID_GROUP_END:
+    case Z_TZX_BLOCK_ID_LOOP_END:
+    case Z_TZX_BLOCK_ID_RETURN:              header = 0; break;
+    case Z_TZX_BLOCK_ID_JUMP:
+    case Z_TZX_BLOCK_ID_LOOP_START:
+    case Z_TZX_BLOCK_ID_CALL_SEQUENCE:
+    case Z_TZX_BLOCK_ID_SELECT:
+    case Z_TZX_BLOCK_ID_INFORMATION:         header = 2; break;
+    case Z_TZX_BLOCK_ID_SECTION_DESCRIPTION:
+    case Z_TZX_BLOCK_ID_HARDWARE_INFORMATION: header = 1; break;
+    case Z_TZX_BLOCK_ID_MESSAGE:             header = 2; break;
+    case Z_TZX_BLOCK_ID_EMULATION_INFORMATION: header = 8; break;
+    case Z_TZX_BLOCK_ID_CUSTOM_INFORMATION:  header = 20; break;
+    case Z_TZX_BLOCK_ID_SNAPSHOT:            header = 4; break;
+    case Z_TZX_BLOCK_ID_GLUE:                header = 9; break;
+    default:                                 header = 4; break;   // 4 байта длины
+    }
+    if (left < header)
+        return -1;
+
+    switch (data[offset]) {
+    case Z_TZX_BLOCK_ID_STANDARD_SPEED_DATA: length = 4 + read16(p + 2); break;
+    case Z_TZX_BLOCK_ID_TURBO_SPEED_DATA:    length = header + read24(p + header - 3); break;
+    case Z_TZX_BLOCK_ID_PULSE_SEQUENCE:      length = 1 + 2 * p[0]; break;
+    case Z_TZX_BLOCK_ID_PURE_DATA:
+    case Z_TZX_BLOCK_ID_DIRECT_RECORDING:    length = header + read24(p + header - 3); break;
+    case Z_TZX_BLOCK_ID_GROUP_START:
+    case Z_TZX_BLOCK_ID_SECTION_DESCRIPTION: length = 1 + p[0]; break;
+    case Z_TZX_BLOCK_ID_CALL_SEQUENCE:       length = 2 + 2 * read16(p); break;
+    // У 28h и 32h длина - WORD (TZX 1.20), не DWORD, как в ZTZXSelect
+    // и ZTZXInformation
+    case Z_TZX_BLOCK_ID_SELECT:
+    case Z_TZX_BLOCK_ID_INFORMATION:         length = 2 + read16(p); break;
+    case Z_TZX_BLOCK_ID_MESSAGE:             length = 2 + p[1]; break;
+    case Z_TZX_BLOCK_ID_HARDWARE_INFORMATION: length = 1 + 3 * p[0]; break;
+    case Z_TZX_BLOCK_ID_CUSTOM_INFORMATION:  length = 20 + read32(p + 16); break;
+    case Z_TZX_BLOCK_ID_SNAPSHOT:            length = 4 + read24(p + 1); break;
+    case Z_TZX_BLOCK_ID_PURE_TONE:
+    case Z_TZX_BLOCK_ID_PAUSE:
+    case Z_TZX_BLOCK_ID_GROUP_END:
+    case Z_TZX_BLOCK_ID_JUMP:
+    case Z_TZX_BLOCK_ID_LOOP_START:
+    case Z_TZX_BLOCK_ID_LOOP_END:
+    case Z_TZX_BLOCK_ID_RETURN:
+    case Z_TZX_BLOCK_ID_EMULATION_INFORMATION:
+    case Z_TZX_BLOCK_ID_GLUE:                length = header; break;
+    default:                                 length = 4 + int64_t(read32(p)); break;
+    }
+    return length <= left ? 1 + length : -1;
+}
+
+void TzxImage::rewind()
+{
+    _state = BLOCK;
+    _block = 0;
+    _idle = 0;
+    _open_edge = false;
+    _loop_block = -1;
+    _call_block = -1;
+    _inflated.clear();
+}
+
+void TzxImage::go_to(int block)
+{
+    _block = std::max(0, block);
+}
+
+TapeImage::Result TzxImage::next(TapePulse &pulse)
+{
+    for (;;) {
+        bool more = false;
+        switch (_state) {
+        case BLOCK: {
+            Result result = start_block();
+            if (result == END and _open_edge) {
+                // Фронт, закрывающий последний импульс ленты
+                _open_edge = false;
+                pulse = { TapePulse::TOGGLE, 0 };
+                return PULSE;
+            }
+            if (result != PULSE)
+                return result;
+            continue;
+        }
+        case LEVEL:
+            _state = BLOCK;
+            _open_edge = false;
+            pulse = { _level_high ? TapePulse::HIGH : TapePulse::LOW, 0 };
+            return PULSE;
+        case DATA:
+            more = _block_data.next(pulse);
+            break;
+        case TONE:
+            if (_pulses > 0) {
+                _pulses--;
+                pulse = { TapePulse::TOGGLE, _tone_pulse };
+                more = true;
+            }
+            break;
+        case SEQUENCE:
+            if (_pulses > 0) {
+                _pulses--;
+                pulse = { TapePulse::TOGGLE, read16(_sequence) };
+                _sequence += 2;
+                more = true;
+            }
+            break;
+        case DIRECT:
+            more = direct_pulse(pulse);
+            break;
+        case CSW:
+            more = csw_pulse(pulse);
+            break;
+        case GENERALIZED:
+            more = generalized_pulse(pulse);
+            break;
+        case PAUSE:
+            if (pause_pulse(pulse)) {
+                _open_edge = false;
+                return PULSE;
+            }
+            _state = BLOCK;
+            continue;
+        }
+
+        if (more) {
+            if (pulse.length) {
+                _idle = 0;
+                _open_edge = true;
+            }
+            return PULSE;
+        }
+        // Блок кончился; у тона и последовательности паузы нет
+        if (_state == TONE or _state == SEQUENCE) {
+            _state = BLOCK;
+            continue;
+        }
+        _inflated.clear();
+        start_pause(_pause_ms);
+        _state = PAUSE;
+    }
+}
+
+// До блока данных доходит обычный start_block(): переходы, циклы и
+// вызовы работают как при игре, описания и паузы пропускаются. Если
+// впереди не 10h/11h с длительностями ПЗУ, состояние возвращается целиком
+bool TzxImage::take_rom_block(const uint8_t *&data, uint32_t &size)
+{
+    auto idle = [this] { return _state == BLOCK or _state == PAUSE or _state == LEVEL; };
+    if (not idle() and not (_state == DATA and _block_data.in_pilot()))
+        return false;
+
+    TzxImage saved(*this);
+    while (idle()) {
+        _state = BLOCK;
+        if (start_block() != PULSE) {
+            *this = saved;
+            return false;
+        }
+    }
+    if (_state != DATA or not _block_data.rom_loadable()) {
+        *this = saved;
+        return false;
+    }
+    data = _block_data.data();
+    size = _block_data.size();
+    _state = BLOCK;
+    _open_edge = false;
+    _idle = 0;
+    return true;
+}
+
+// Разбор блока _block. PULSE - блок начат или пропущен, продолжать
+TapeImage::Result TzxImage::start_block()
+{
+    if (_block >= blocks() or ++_idle > MAX_IDLE_BLOCKS)
+        return END;
+
+    int current = _block++;
+    int64_t offset = _index[size_t(current)];
+    const uint8_t *body = _data + offset + 1;
+    const uint8_t *end = _data + offset + block_size(_data, _size, offset);
+
+    switch (_data[offset]) {
+    case Z_TZX_BLOCK_ID_STANDARD_SPEED_DATA: {
+        const ZTZXStandardSpeedData *block = reinterpret_cast<const ZTZXStandardSpeedData *>(body);
+        const uint8_t *data = body + sizeof(ZTZXStandardSpeedData);
+        uint32_t size = Z_16BIT_LITTLE_ENDIAN(block->data_size);
+        _block_data.set_standard(data, size);
+        _block_data.start(data, size);
+        _pause_ms = Z_16BIT_LITTLE_ENDIAN(block->pause_duration_ms);
+        _state = DATA;
+        break;
+    }
+    case Z_TZX_BLOCK_ID_TURBO_SPEED_DATA: {
+        const ZTZXTurboSpeedData *block = reinterpret_cast<const ZTZXTurboSpeedData *>(body);
+        _block_data.pilot_pulse = Z_16BIT_LITTLE_ENDIAN(block->cycles_per_pilot_pulse);
+        _block_data.sync1_pulse = Z_16BIT_LITTLE_ENDIAN(block->cycles_per_sync_high_pulse);
+        _block_data.sync2_pulse = Z_16BIT_LITTLE_ENDIAN(block->cycles_per_sync_low_pulse);
+        _block_data.zero_pulse = Z_16BIT_LITTLE_ENDIAN(block->cycles_per_bit_0_pulse);
+        _block_data.one_pulse = Z_16BIT_LITTLE_ENDIAN(block->cycles_per_bit_1_pulse);
+        _block_data.pilot_pulses = Z_16BIT_LITTLE_ENDIAN(block->pilot_tone_pulse_count);
+        _block_data.sync = true;
+        _block_data.start(body + sizeof(ZTZXTurboSpeedData), read24(block->data_size),
+                          block->last_byte_bit_count);
+        _pause_ms = Z_16BIT_LITTLE_ENDIAN(block->pause_duration_ms);
+        _state = DATA;
+        break;
+    }
+    case Z_TZX_BLOCK_ID_PURE_TONE: {
+        const ZTZXPureTone *block = reinterpret_cast<const ZTZXPureTone *>(body);
+        _tone_pulse = Z_16BIT_LITTLE_ENDIAN(block->cycles_per_pulse);
+        _pulses = Z_16BIT_LITTLE_ENDIAN(block->pulse_count);
+        _state = TONE;
+        break;
+    }
+    case Z_TZX_BLOCK_ID_PULSE_SEQUENCE:
+        _pulses = body[0];
+        _sequence = body + 1;
+        _state = SEQUENCE;
+        break;
+    case Z_TZX_BLOCK_ID_PURE_DATA: {
+        const ZTZXPureData *block = reinterpret_cast<const ZTZXPureData *>(body);
+        _block_data.zero_pulse = Z_16BIT_LITTLE_ENDIAN(block->cycles_per_bit_0_pulse);
+        _block_data.one_pulse = Z_16BIT_LITTLE_ENDIAN(block->cycles_per_bit_1_pulse);
+        _block_data.pilot_pulses = 0;
+        _block_data.sync = false;
+        _block_data.start(body + sizeof(ZTZXPureData), read24(block->data_size),
+                          block->last_byte_bit_count);
+        _pause_ms = Z_16BIT_LITTLE_ENDIAN(block->pause_duration_ms);
+        _state = DATA;
+        break;
+    }
+    case Z_TZX_BLOCK_ID_DIRECT_RECORDING: {
+        const ZTZXDirectRecording *block = reinterpret_cast<const ZTZXDirectRecording *>(body);
+        uint32_t size = read24(block->data_size);
+        int last_bits = block->last_byte_bit_count;
+        if (last_bits < 1 or last_bits > 8)
+            last_bits = 8;
+        _samples = body + sizeof(ZTZXDirectRecording);
+        _sample = 0;
+        _sample_count = size ? uint64_t(size - 1) * 8 + uint64_t(last_bits) : 0;
+        _sample_cycles = Z_16BIT_LITTLE_ENDIAN(block->cycles_per_pulse);
+        _pause_ms = Z_16BIT_LITTLE_ENDIAN(block->pause_duration_ms);
+        _state = DIRECT;
+        break;
+    }
+    case Z_TZX_BLOCK_ID_CSW_RECORDING: {
+        const ZTZXCSWRecording *block = reinterpret_cast<const ZTZXCSWRecording *>(body);
+        _csw_rate = read24(block->sampling_rate);
+        _csw_time = 0;
+        _csw = body + sizeof(ZTZXCSWRecording);
+        _csw_end = std::max(end, _csw);
+        _pause_ms = Z_16BIT_LITTLE_ENDIAN(block->pause_duration_ms);
+        if (block->compression_type == Z_TZX_CSW_COMPRESSION_TYPE_Z_RLE) {
+            // qUncompress ждёт впереди ожидаемый размер (big-endian);
+            // RLE - не меньше байта на импульс
+            uint32_t expected = Z_32BIT_LITTLE_ENDIAN(block->pulse_count);
+            QByteArray packed(4, 0);
+            packed[0] = char(expected >> 24);
+            packed[1] = char(expected >> 16);
+            packed[2] = char(expected >> 8);
+            packed[3] = char(expected);
+            packed.append(reinterpret_cast<const char *>(_csw), int(_csw_end - _csw));
+            _inflated = qUncompress(packed);
+            _csw = reinterpret_cast<const uint8_t *>(_inflated.constData());
+            _csw_end = _csw + _inflated.size();
+        }
+        _state = CSW;
+        break;
+    }
+    case Z_TZX_BLOCK_ID_GENERALIZED_DATA: {
+        const ZTZXGeneralizedData *block = reinterpret_cast<const ZTZXGeneralizedData *>(body);
+        _pause_ms = Z_16BIT_LITTLE_ENDIAN(block->pause_duration_ms);
+        start_generalized(body, end);
+        _state = GENERALIZED;
+        break;
+    }
+    case Z_TZX_BLOCK_ID_PAUSE: {
+        const ZTZXPause *block = reinterpret_cast<const ZTZXPause *>(body);
+        uint32_t ms = Z_16BIT_LITTLE_ENDIAN(block->duration_ms);
+        if (ms == 0) {
+            _idle = 0;
+            return STOP;
+        }
+        start_pause(ms);
+        _state = PAUSE;
+        break;
+    }
+    case Z_TZX_BLOCK_ID_JUMP: {
+        const ZTZXJump *block = reinterpret_cast<const ZTZXJump *>(body);
+        go_to(current + int16_t(Z_16BIT_LITTLE_ENDIAN(block->relative_offset)));
+        break;
+    }
+    case Z_TZX_BLOCK_ID_LOOP_START: {
+        const ZTZXLoopStart *block = reinterpret_cast<const ZTZXLoopStart *>(body);
+        _loop_block = _block;
+        _loop_count = Z_16BIT_LITTLE_ENDIAN(block->count);
+        break;
+    }
+    case Z_TZX_BLOCK_ID_LOOP_END:
+        if (_loop_block >= 0 and --_loop_count > 0)
+            go_to(_loop_block);
+        else
+            _loop_block = -1;
+        break;
+    case Z_TZX_BLOCK_ID_CALL_SEQUENCE:
+        if (read16(body) > 0) {
+            _call_block = current;
+            _call_next = 1;
+            go_to(current + int16_t(read16(body + 2)));
+        }
+        break;
+    case Z_TZX_BLOCK_ID_RETURN:
+        if (_call_block >= 0) {
+            const uint8_t *call = _data + _index[size_t(_call_block)] + 1;
+            if (_call_next < int(read16(call))) {
+                go_to(_call_block + int16_t(read16(call + 2 + 2 * _call_next)));
+                _call_next++;
+            } else {
+                go_to(_call_block + 1);
+                _call_block = -1;
+            }
+        }
+        break;
+    case Z_TZX_BLOCK_ID_STOP_IF_48K:
+        if (_48k) {
+            _idle = 0;
+            return STOP;
+        }
+        break;
+    case Z_TZX_BLOCK_ID_SET_SIGNAL_LEVEL: {
+        const ZTZXSetSignalLevel *block = reinterpret_cast<const ZTZXSetSignalLevel *>(body);
+        _level_high = block->level == Z_TZX_SIGNAL_LEVEL_HIGH;
+        _state = LEVEL;
+        break;
+    }
+    default:
+        // Описания, группы, выбор, C64 и прочее без звука
+        break;
+    }
+    return PULSE;
+}
+
+// Прямая запись: подряд идущие сэмплы одного уровня - один импульс,
+// целые байты 00/FF проходятся за шаг
+bool TzxImage::direct_pulse(TapePulse &pulse)
+{
+    if (_sample >= _sample_count)
+        return false;
+
+    auto level = [this](uint64_t sample) {
+        return (_samples[sample >> 3] >> (7 - (sample & 7))) & 1;
+    };
+    int high = level(_sample);
+    uint8_t same = high ? 0xFF : 0x00;
+    uint64_t start = _sample;
+    uint64_t limit = std::min(_sample_count,
+                              _sample + UINT32_MAX / std::max<uint32_t>(_sample_cycles, 1));
+    while (_sample < limit) {
+        if ((_sample & 7) == 0 and _sample + 8 <= limit and _samples[_sample >> 3] == same) {
+            _sample += 8;
+            continue;
+        }
+        if (level(_sample) != high)
+            break;
+        _sample++;
+    }
+    pulse = { high ? TapePulse::HIGH : TapePulse::LOW,
+              uint32_t((_sample - start) * _sample_cycles) };
+    return true;
+}
+
+// CSW v2 RLE: байт - длина импульса в сэмплах, 0 - следом 4 байта длины
+bool TzxImage::csw_pulse(TapePulse &pulse)
+{
+    if (_csw >= _csw_end or _csw_rate == 0)
+        return false;
+
+    uint32_t samples = *_csw++;
+    if (samples == 0) {
+        if (_csw_end - _csw < 4) {
+            _csw = _csw_end;
+            return false;
+        }
+        samples = read32(_csw);
+        _csw += 4;
+    }
+    uint64_t from = _csw_time * _cpu_hz / _csw_rate;
+    _csw_time += samples;
+    uint64_t to = _csw_time * _cpu_hz / _csw_rate;
+    pulse = { TapePulse::TOGGLE, uint32_t(std::min<uint64_t>(to - from, UINT32_MAX)) };
+    return true;
+}
+
+// Таблицы 19h лежат подряд за заголовком: символы пилота, поток RLE
+// пилота, символы данных, поток данных по ceil(log2(символов)) бит
+void TzxImage::start_generalized(const uint8_t *block, const uint8_t *end)
+{
+    const ZTZXGeneralizedData *header = reinterpret_cast<const ZTZXGeneralizedData *>(block);
+    uint64_t size = uint64_t(end - block);
+    uint64_t offset = sizeof(ZTZXGeneralizedData);
+
+    _pilot = {};
+    _symbols = {};
+    _symbol_bits = 0;
+    _in_data = false;
+    _position = 0;
+    _repeat = 0;
+    _symbol = nullptr;
+
+    Symbols pilot;
+    pilot.length = Z_32BIT_LITTLE_ENDIAN(header->pilot_sync_symbol_count);
+    if (pilot.length) {
+        pilot.count = header->pilot_sync_symbol_definition_count;
+        if (pilot.count == 0)
+            pilot.count = 256;
+        pilot.pulses = header->pulses_per_pilot_sync_symbol_maximum;
+        pilot.table = block + offset;
+        offset += uint64_t(pilot.count) * (1 + 2 * pilot.pulses);
+        pilot.stream = block + std::min(offset, size);
+        offset += uint64_t(pilot.length) * sizeof(ZTZXPulseRLE);
+    }
+    Symbols symbols;
+    symbols.length = Z_32BIT_LITTLE_ENDIAN(header->data_symbol_count);
+    int bits = 0;
+    if (symbols.length) {
+        symbols.count = header->data_symbol_definition_count;
+        if (symbols.count == 0)
+            symbols.count = 256;
+        symbols.pulses = header->pulses_per_data_symbol_maximum;
+        symbols.table = block + std::min(offset, size);
+        offset += uint64_t(symbols.count) * (1 + 2 * symbols.pulses);
+        while ((1 << bits) < symbols.count)
+            bits++;
+        symbols.stream = block + std::min(offset, size);
+        offset += (uint64_t(symbols.length) * uint64_t(bits) + 7) / 8;
+    }
+    // Таблицы не помещаются в блок - остаётся только пауза
+    if (offset > size)
+        return;
+    _pilot = pilot;
+    _symbols = symbols;
+    _symbol_bits = bits;
+}
+
+bool TzxImage::generalized_pulse(TapePulse &pulse)
+{
+    for (;;) {
+        if (_symbol) {
+            // Строка короче максимума кончается импульсом нулевой длины
+            if (_symbol_pulse < _symbol_pulses) {
+                uint32_t length = read16(_symbol + 1 + 2 * _symbol_pulse);
+                if (length != 0) {
+                    // Флаги полярности 0..3 совпадают с порядком TapePulse::Edge
+                    TapePulse::Edge edge = _symbol_pulse == 0 ? TapePulse::Edge(_symbol[0] & 3)
+                                                              : TapePulse::TOGGLE;
+                    _symbol_pulse++;
+                    pulse = { edge, length };
+                    return true;
+                }
+            }
+            _symbol = nullptr;
+        }
+
+        int symbol;
+        const Symbols *symbols;
+        if (not _in_data) {
+            if (_repeat == 0) {
+                if (_position >= _pilot.length) {
+                    _in_data = true;
+                    _position = 0;
+                    continue;
+                }
+                const ZTZXPulseRLE *entry =
+                    reinterpret_cast<const ZTZXPulseRLE *>(_pilot.stream) + _position++;
+                _pilot_symbol = entry->symbol;
+                _repeat = int(Z_16BIT_LITTLE_ENDIAN(entry->repetitions));
+                continue;
+            }
+            _repeat--;
+            symbol = _pilot_symbol;
+            symbols = &_pilot;
+        } else {
+            if (_position >= _symbols.length)
+                return false;
+            uint64_t bit = uint64_t(_position++) * uint64_t(_symbol_bits);
+            symbol = 0;
+            for (int i = 0; i < _symbol_bits; i++, bit++)
+                symbol = symbol << 1 | ((_symbols.stream[bit >> 3] >> (7 - (bit & 7))) & 1);
+            symbols = &_symbols;
+        }
+        if (symbol >= symbols->count)
+            continue;
+        _symbol = symbols->table + symbol * (1 + 2 * symbols->pulses);
+        _symbol_pulses = symbols->pulses;
+        _symbol_pulse = 0;
+    }
+}
@@ -0,0 +1,106 @@
+#ifndef TZXIMAGE_H
+#define TZXIMAGE_H
+
+#include <QByteArray>
+#include <vector>
+#include "tapeimage.h"
+
+// Образ .tzx (Z, TZX.h): блоки с ID проигрываются как итератор по графу
+// блоков - переходы, циклы и вызовы меняют номер следующего блока.
+// Заголовки читаются структурами Z прямо из отображённого файла, данные
+// (в том числе прямая запись 15h и CSW 18h) разбираются по импульсу
+// за вызов, так что образ любого размера не копируется. При открытии
+// строится только таблица смещений блоков - по 8 байт на блок.
+//
+// Исключение - CSW со сжатием Z-RLE: такой блок распаковывается
+// целиком (qUncompress), потоковой распаковки в QtCore нет.
+class TzxImage : public TapeImage
+{
+public:
+    // Переходы без единого импульса подряд, после которых лента
+    // считается зацикленной (Jump 0 и т.п.)
+    static constexpr int MAX_IDLE_BLOCKS = 1 << 20;
+
+    // false - не TZX или нет ни одного блока
+    bool open(const uint8_t *data, int64_t size);
+
+    Result next(TapePulse &pulse) override;
+    void rewind() override;
+    int block() const override { return _block; }
+    int blocks() const override { return int(_index.size()); }
+    bool take_rom_block(const uint8_t *&data, uint32_t &size) override;
+
+    // Длина блока с ID по смещению offset, -1 - блок обрезан
+    static int64_t block_size(const uint8_t *data, int64_t size, int64_t offset);
+
+private:
+    enum State { BLOCK, LEVEL, DATA, TONE, SEQUENCE, DIRECT, CSW, GENERALIZED, PAUSE };
+
+    Result start_block();
+    void go_to(int block);
+    bool direct_pulse(TapePulse &pulse);
+    bool csw_pulse(TapePulse &pulse);
+    bool generalized_pulse(TapePulse &pulse);
+    void start_generalized(const uint8_t *block, const uint8_t *end);
+
+    const uint8_t *_data { nullptr };
+    int64_t _size { 0 };
+    std::vector<int64_t> _index;    // смещения блоков (байта ID)
+
+    State _state { BLOCK };
+    int _block { 0 };               // следующий блок
+    int _idle { 0 };
+    uint32_t _pause_ms { 0 };       // пауза после текущего блока
+    bool _open_edge { false };      // последний импульс не закрыт фронтом
+    bool _level_high { false };     // 2Bh
+
+    // Циклы и вызовы не вкладываются: хватает одного уровня
+    int _loop_block { -1 };
+    int _loop_count { 0 };
+    int _call_block { -1 };         // блок 26h, из которого вызваны
+    int _call_next { 0 };           // номер следующего вызова в нём
+
+    // 10h, 11h, 14h
+    TapeData _block_data;
+
+    // 12h, 13h
+    uint32_t _tone_pulse { 0 };
+    int _pulses { 0 };
+    const uint8_t *_sequence { nullptr };
+
+    // 15h: биты - уровни сэмплов, старший первым
+    const uint8_t *_samples { nullptr };
+    uint64_t _sample { 0 };
+    uint64_t _sample_count { 0 };
+    uint32_t _sample_cycles { 0 };
+
+    // 18h: длины импульсов RLE в сэмплах, время копится в сэмплах,
+    // чтобы округление до тактов не уводило частоту
+    const uint8_t *_csw { nullptr };
+    const uint8_t *_csw_end { nullptr };
+    QByteArray _inflated;
+    uint32_t _csw_rate { 0 };
+    uint64_t _csw_time { 0 };
+
+    // 19h: таблицы символов и потоки пилота и данных
+    struct Symbols
+    {
+        const uint8_t *table { nullptr };
+        int count { 0 };            // символов в таблице
+        int pulses { 0 };           // импульсов в строке таблицы
+        const uint8_t *stream { nullptr };
+        uint32_t length { 0 };      // записей RLE пилота или символов данных
+    };
+    Symbols _pilot;
+    Symbols _symbols;
+    int _symbol_bits { 0 };
+    bool _in_data { false };
+    uint32_t _position { 0 };       // запись пилота или символ данных
+    int _repeat { 0 };              // осталось повторов записи пилота
+    int _pilot_symbol { 0 };
+    const uint8_t *_symbol { nullptr };
+    int _symbol_pulses { 0 };
+    int _symbol_pulse { 0 };
+};
+
+#endif // TZXIMAGE_H
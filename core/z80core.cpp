@@ -0,0 +1,44 @@
+#include "z80core.h"
+#include "businterface48.h"
+#include "businterface128.h"
+
+#include <Z/macros/value.h>
+#include <Z/macros/pointer.h>
+
+// Z80.c включается сюда один раз на каждую шину, каждый раз в своё
+// пространство имён. Макросы ниже подменяют вызовы object->read/write/in/out.
+#define CPU_Z80_CUSTOM_CALLBACKS
+#define Z80_BUS(object) \
+    static_cast<CPU_Z80_BUS *>(static_cast<BusInterface *>((object)->context))
+#define READ_8(address)         Z80_BUS(object)->page_read8((zuint16)(address))
+#define WRITE_8(address, value) Z80_BUS(object)->page_write8((zuint16)(address), (zuint8)(value))
+#define IN(port)                Z80_BUS(object)->CPU_Z80_BUS::io_read8((zuint16)(port))
+#define OUT(port, value)        Z80_BUS(object)->CPU_Z80_BUS::io_write8((zuint16)(port), (zuint8)(value))
+
+// LDIR/CPIR/INIR/OTIR и их пары крутятся внутри одного вызова,
+// HALT сразу доматывает такты до конца вызова (до следующего INT)
+#define CPU_Z80_BULK_REPEAT
+#define CPU_Z80_HALT_SKIP
+#define BULK_IO_SAFE(port)      Z80_BUS(object)->CPU_Z80_BUS::io_bulk_safe((zuint16)(port))
+
+#define CPU_Z80_BUS BusInterface48
+namespace z80_bus48 {
+#include "../3rdparty/Z80/sources/Z80.c"
+}
+#undef CPU_Z80_BUS
+
+#define CPU_Z80_BUS BusInterface128
+namespace z80_bus128 {
+#include "../3rdparty/Z80/sources/Z80.c"
+}
+#undef CPU_Z80_BUS
+
+template <> zusize Z80Core<BusInterface48>::run(Z80 *cpu, zusize cycles)
+{
+    return z80_bus48::z80_run(cpu, cycles);
+}
+
+template <> zusize Z80Core<BusInterface128>::run(Z80 *cpu, zusize cycles)
+{
+    return z80_bus128::z80_run(cpu, cycles);
+}
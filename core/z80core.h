@@ -0,0 +1,22 @@
+#ifndef Z80CORE_H
+#define Z80CORE_H
+
+#include "emulation/CPU/Z80.h"
+
+// Ядро Z80, собранное под конкретную шину: обращения к памяти и портам
+// вызываются напрямую, без указателей на функции из структуры Z80.
+// Для каждой модели машины есть своя специализация (z80core.cpp).
+// Остальные функции (z80_reset, z80_int, z80_nmi) общие с C API.
+template <class Bus>
+struct Z80Core
+{
+    static zusize run(Z80 *cpu, zusize cycles);
+};
+
+class BusInterface48;
+class BusInterface128;
+
+template <> zusize Z80Core<BusInterface48>::run(Z80 *cpu, zusize cycles);
+template <> zusize Z80Core<BusInterface128>::run(Z80 *cpu, zusize cycles);
+
+#endif // Z80CORE_H
@@ -0,0 +1,548 @@
+#include "z80jit.h"
+#include "businterface48.h"
+#include "businterface128.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define Z80_JIT_X86_64
+#   ifdef _WIN32
+#       include <windows.h>
+#   else
+#       include <sys/mman.h>
+#   endif
+#endif
+
+#include <Z/macros/value.h>
+#include <Z/macros/pointer.h>
+
+// Z80.c собирается под каждую шину, как в z80core.cpp, но запись в память
+// идёт через Z80Jit::write8, чтобы ловить самомодифицирующийся код, а OUT -
+// через Z80Jit::out8, чтобы заметить переключение банков.
+#define CPU_Z80_CUSTOM_CALLBACKS
+#define Z80_JIT(object)         static_cast<Z80Jit *>((object)->context)
+#define Z80_BUS(object)         static_cast<CPU_Z80_BUS *>(Z80_JIT(object)->bus())
+#define READ_8(address)         Z80_JIT(object)->read8((zuint16)(address))
+#define WRITE_8(address, value) Z80_JIT(object)->write8((zuint16)(address), (zuint8)(value))
+#define IN(port)                Z80_BUS(object)->CPU_Z80_BUS::io_read8((zuint16)(port))
+#define OUT(port, value)        Z80_JIT(object)->out8<CPU_Z80_BUS>((zuint16)(port), (zuint8)(value))
+#define CPU_Z80_BULK_REPEAT
+#define CPU_Z80_HALT_SKIP
+#define BULK_IO_SAFE(port)      Z80_BUS(object)->CPU_Z80_BUS::io_bulk_safe((zuint16)(port))
+
+// Доступ к внутренностям Z80.c из общего для всех шин кода ниже
+#define Z80_JIT_CORE                                            \
+    struct Core                                                 \
+    {                                                           \
+        static zuint8 nmi(Z80 *object) { return accept_nmi(object); } \
+        static zuint8 irq(Z80 *object) { return accept_int(object); } \
+        static const Instruction *table() { return instruction_table; } \
+    };
+
+#define CPU_Z80_BUS BusInterface48
+namespace z80_jit48 {
+#include "../3rdparty/Z80/sources/Z80.c"
+Z80_JIT_CORE
+}
+#undef CPU_Z80_BUS
+
+#define CPU_Z80_BUS BusInterface128
+namespace z80_jit128 {
+#include "../3rdparty/Z80/sources/Z80.c"
+Z80_JIT_CORE
+}
+#undef CPU_Z80_BUS
+
+namespace z80_jit {
+
+// Карта кода для слотов, запись в которые не доходит до памяти (ПЗУ)
+static const zuint8 no_code[BusInterface::PAGE_SIZE] {};
+
+enum {
+    NEXT,       // инструкция продолжает блок
+    LAST,       // переход, EI, повторяющаяся блочная: входит в блок последней
+    INTERPRET   // ввод-вывод, HALT, недокументированные префиксы
+};
+
+// Длина инструкции по адресу p (до конца страницы осталось avail байт)
+// и её роль в блоке. 0 - инструкция не помещается в страницу.
+static int decode(const zuint8 *p, int avail, int *kind)
+{
+    zuint8 op = p[0];
+    int x = op >> 6, y = (op >> 3) & 7, z = op & 7;
+    int length = 1;
+
+    *kind = NEXT;
+
+    if (op == 0xCB) {
+        length = 2;
+    } else if (op == 0xED) {
+        if (avail < 2)
+            return 0;
+        zuint8 op2 = p[1];
+        int y2 = (op2 >> 3) & 7, z2 = op2 & 7;
+        length = 2;
+        if ((op2 & 0xC0) == 0x40) {
+            if (z2 == 3)
+                length = 4;                     // LD (nn),rr / LD rr,(nn)
+            else if (z2 == 0 or z2 == 1)
+                *kind = INTERPRET;              // IN r,(C) / OUT (C),r
+            else if (z2 == 5)
+                *kind = LAST;                   // RETN / RETI
+        } else if ((op2 & 0xE4) == 0xA0) {
+            if (z2 >= 2)
+                *kind = INTERPRET;              // INI/OUTI и их повторы
+            else if (y2 >= 6)
+                *kind = LAST;                   // LDIR/CPIR/LDDR/CPDR
+        }
+    } else if (op == 0xDD or op == 0xFD) {
+        if (avail < 2)
+            return 0;
+        zuint8 op2 = p[1];
+        // Таблицы одинаковы во всех сборках Z80.c
+        if (z80_jit48::instruction_table_XY[op2] == z80_jit48::XY_illegal) {
+            *kind = INTERPRET;
+            return 1;
+        }
+        int x2 = op2 >> 6, y2 = (op2 >> 3) & 7, z2 = op2 & 7;
+        length = 2;
+        if (op2 == 0xCB)
+            length = 4;
+        else if (op2 == 0x21 or op2 == 0x22 or op2 == 0x2A)
+            length = 4;
+        else if (op2 == 0x36)
+            length = 4;
+        else if (op2 == 0x34 or op2 == 0x35 or op2 == 0x26 or op2 == 0x2E)
+            length = 3;
+        else if ((x2 == 1 and (y2 == 6) != (z2 == 6)) or (x2 == 2 and z2 == 6))
+            length = 3;                         // операнд (IX+d)
+        else if (op2 == 0xE9)
+            *kind = LAST;                       // JP (IX)
+    } else if (x == 0) {
+        if (z == 0 and y >= 2) {
+            length = 2;                         // DJNZ / JR
+            *kind = LAST;
+        } else if (z == 1 and (y & 1) == 0) {
+            length = 3;                         // LD rr,nn
+        } else if (z == 2 and y >= 4) {
+            length = 3;                         // LD (nn),HL / A и обратно
+        } else if (z == 6) {
+            length = 2;                         // LD r,n
+        }
+    } else if (x == 1) {
+        if (op == 0x76)
+            *kind = INTERPRET;                  // HALT
+    } else if (x == 3) {
+        switch (z) {
+        case 0: *kind = LAST; break;                        // RET cc
+        case 1: if (y == 1 or y == 5) *kind = LAST; break;  // RET, JP (HL)
+        case 2: length = 3; *kind = LAST; break;            // JP cc,nn
+        case 3:
+            if (y == 0) { length = 3; *kind = LAST; }       // JP nn
+            else if (y == 2 or y == 3) { length = 2; *kind = INTERPRET; }
+            else if (y == 7) *kind = LAST;                  // EI
+            break;
+        case 4: length = 3; *kind = LAST; break;            // CALL cc,nn
+        case 5: if (y == 1) { length = 3; *kind = LAST; } break; // CALL nn
+        case 6: length = 2; break;                          // ALU A,n
+        case 7: *kind = LAST; break;                        // RST
+        }
+    }
+
+    return length <= avail ? length : 0;
+}
+
+// Тот же цикл, что z80_run, но перед выборкой инструкции проверяется
+// кэш: готовый блок исполняется целиком, пока не кончатся такты.
+// Прерывания внутри run() не появляются (INT и NMI выставляются снаружи
+// между вызовами), а EI/RETN/RETI завершают блок, поэтому проверять их
+// нужно только на границах блоков.
+template <class Core>
+static zusize run_cached(Z80 *object, zusize cycles, Z80Jit *jit)
+{
+    CYCLES = 0;
+    CYCLE_LIMIT = cycles;
+    R7 = R;
+
+    while (CYCLES < cycles)
+    {
+        if (NMI)
+        {
+            CYCLES += Core::nmi(object);
+            continue;
+        }
+
+        if (INT && IFF1 && !EI)
+        {
+            CYCLES += Core::irq(object);
+            continue;
+        }
+
+        // После EI прерывание ждёт ровно одну инструкцию, блок бы его
+        // пропустил - такую инструкцию исполняет интерпретатор
+        const Z80Jit::Block *block =
+                EI && INT && IFF1 ? nullptr : jit->lookup(PC);
+
+        if (block and block->count)
+            EI = FALSE;     // внутри блока EI может быть только последней
+
+        if (block and block->native)
+        {
+            block->native(object, cycles, jit->abort_flag());
+        }
+        else if (block and block->count)
+        {
+            const Z80Jit::Handler *op = &jit->current()->ops[block->first];
+            const zuint8 *code = &jit->current()->opcodes[block->first];
+            const Z80Jit::Handler *end = op + block->count;
+
+            do {
+                R++;
+                BYTE0 = *code++;
+                CYCLES += (*op++)(object);
+            } while (op != end and CYCLES < cycles and !jit->aborted());
+        }
+        else
+        {
+            R++;
+            EI = FALSE;
+            CYCLES += Core::table()[BYTE0 = jit->read8(PC)](object);
+        }
+
+        if (jit->aborted())
+            jit->collect();
+    }
+
+    R = R_ALL;
+    return CYCLES;
+}
+
+#ifdef Z80_JIT_X86_64
+
+// Смещения полей Z80, с которыми работает сгенерированный код
+struct Offsets
+{
+    zsint32 r, byte0, cycles;
+
+    Offsets()
+    {
+        static Z80 dummy;
+        Z80 *object = &dummy;
+        const zuint8 *base = reinterpret_cast<const zuint8 *>(object);
+        r = zsint32(reinterpret_cast<const zuint8 *>(&R) - base);
+        byte0 = zsint32(reinterpret_cast<const zuint8 *>(&BYTE0) - base);
+        cycles = zsint32(reinterpret_cast<const zuint8 *>(&CYCLES) - base);
+    }
+};
+
+static const size_t CHUNK_SIZE = 64 * 1024;
+
+// Самый длинный блок: пролог, эпилог и по 70 байт на инструкцию
+static const size_t MAX_CODE = 32 + Z80Jit::MAX_BLOCK * 70;
+
+static zuint8 *alloc_code()
+{
+#ifdef _WIN32
+    void *p = VirtualAlloc(nullptr, CHUNK_SIZE, MEM_COMMIT | MEM_RESERVE,
+                           PAGE_EXECUTE_READWRITE);
+    return static_cast<zuint8 *>(p);
+#else
+    void *p = mmap(nullptr, CHUNK_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : static_cast<zuint8 *>(p);
+#endif
+}
+
+static void free_code(zuint8 *p)
+{
+#ifdef _WIN32
+    VirtualFree(p, 0, MEM_RELEASE);
+#else
+    munmap(p, CHUNK_SIZE);
+#endif
+}
+
+// Генератор блока. Регистры: rbx - Z80 *, r12 - бюджет тактов,
+// r13 - указатель на флаг прерывания блока (запись в транслированный код).
+// Для каждой инструкции:
+//      inc   byte [rbx + R]
+//      mov   byte [rbx + BYTE0], opcode
+//      mov   rdi/rcx, rbx
+//      mov   rax, handler
+//      call  rax
+//      movzx eax, al
+//      add   [rbx + CYCLES], rax
+//      cmp   [rbx + CYCLES], r12       ; кроме последней
+//      jae   exit
+//      cmp   byte [r13], 0
+//      jne   exit
+class Emitter
+{
+public:
+    explicit Emitter(zuint8 *code) : _code(code), _at(code) {}
+
+    size_t size() const { return size_t(_at - _code); }
+
+    void prologue()
+    {
+        bytes({0x53, 0x41, 0x54, 0x41, 0x55});              // push rbx, r12, r13
+#ifdef _WIN32
+        bytes({0x48, 0x89, 0xCB, 0x49, 0x89, 0xD4, 0x4D, 0x89, 0xC5}); // rbx, r12, r13 <- rcx, rdx, r8
+        bytes({0x48, 0x83, 0xEC, 0x20});                    // sub rsp, 32 (shadow space)
+#else
+        bytes({0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4, 0x49, 0x89, 0xD5}); // rbx, r12, r13 <- rdi, rsi, rdx
+#endif
+    }
+
+    void instruction(const Offsets &o, zuint8 opcode, Z80Jit::Handler handler, bool last)
+    {
+        bytes({0xFE, 0x83}); disp(o.r);                     // inc byte [rbx + R]
+        bytes({0xC6, 0x83}); disp(o.byte0); byte(opcode);   // mov byte [rbx + BYTE0], imm8
+#ifdef _WIN32
+        bytes({0x48, 0x89, 0xD9});                          // mov rcx, rbx
+#else
+        bytes({0x48, 0x89, 0xDF});                          // mov rdi, rbx
+#endif
+        bytes({0x48, 0xB8}); imm64(reinterpret_cast<zuint64>(handler)); // mov rax, imm64
+        bytes({0xFF, 0xD0});                                // call rax
+        bytes({0x0F, 0xB6, 0xC0});                          // movzx eax, al
+        bytes({0x48, 0x01, 0x83}); disp(o.cycles);          // add [rbx + CYCLES], rax
+        if (last)
+            return;
+        bytes({0x4C, 0x39, 0xA3}); disp(o.cycles);          // cmp [rbx + CYCLES], r12
+        bytes({0x0F, 0x83}); exit_jump();                   // jae exit
+        bytes({0x41, 0x80, 0x7D, 0x00, 0x00});              // cmp byte [r13], 0
+        bytes({0x0F, 0x85}); exit_jump();                   // jne exit
+    }
+
+    void epilogue()
+    {
+        for (zuint8 *jump : _exits) {
+            zsint32 rel = zsint32(_at - (jump + 4));
+            std::memcpy(jump, &rel, 4);
+        }
+#ifdef _WIN32
+        bytes({0x48, 0x83, 0xC4, 0x20});                    // add rsp, 32
+#endif
+        bytes({0x41, 0x5D, 0x41, 0x5C, 0x5B, 0xC3});        // pop r13, r12, rbx; ret
+    }
+
+private:
+    void byte(zuint8 b) { *_at++ = b; }
+    void bytes(std::initializer_list<zuint8> list) { for (zuint8 b : list) byte(b); }
+    void disp(zsint32 d) { std::memcpy(_at, &d, 4); _at += 4; }
+    void imm64(zuint64 v) { std::memcpy(_at, &v, 8); _at += 8; }
+    void exit_jump() { _exits.push_back(_at); disp(0); }
+
+    zuint8 *_code;
+    zuint8 *_at;
+    std::vector<zuint8 *> _exits;
+};
+
+#endif // Z80_JIT_X86_64
+
+} // namespace z80_jit
+
+Z80Jit::Z80Jit(BusInterface *bus, bool native)
+    : _bus(bus)
+#ifdef Z80_JIT_X86_64
+    , _native(native)
+#else
+    , _native(false)
+#endif
+{
+    (void)native;
+    flush();
+    if (dynamic_cast<BusInterface128 *>(bus)) {
+        _run = z80_jit::run_cached<z80_jit128::Core>;
+        _table = z80_jit128::Core::table();
+    } else {
+        _run = z80_jit::run_cached<z80_jit48::Core>;
+        _table = z80_jit48::Core::table();
+    }
+}
+
+zuint32 Z80Jit::s_int_data(void *context)
+{
+    Z80Jit *jit = static_cast<Z80Jit *>(context);
+    return jit->_int_data(jit->_context);
+}
+
+void Z80Jit::s_halt(void *context, zboolean state)
+{
+    Z80Jit *jit = static_cast<Z80Jit *>(context);
+    if (jit->_halt)
+        jit->_halt(jit->_context, state);
+}
+
+zusize Z80Jit::run(Z80 *cpu, zusize cycles)
+{
+    _context = cpu->context;
+    _int_data = cpu->int_data;
+    _halt = cpu->halt;
+    cpu->context = this;
+    cpu->int_data = s_int_data;
+    cpu->halt = s_halt;
+
+    map_slots();
+    zusize result = _run(cpu, cycles, this);
+
+    cpu->context = _context;
+    cpu->int_data = _int_data;
+    cpu->halt = _halt;
+    return result;
+}
+
+void Z80Jit::flush()
+{
+    _pages.clear();
+    _garbage.clear();
+    _current = nullptr;
+    _abort = false;
+    for (int n = 0; n < BusInterface::PAGE_COUNT; n++) {
+        _read_ptr[n] = nullptr;
+        _read_slot[n] = _write_slot[n] = nullptr;
+        _code_slot[n] = z80_jit::no_code;
+    }
+}
+
+Z80Jit::Page * Z80Jit::page_for(const uint8_t *data)
+{
+    std::unique_ptr<Page> &page = _pages[data];
+    if (not page) {
+        page.reset(new Page);
+        page->data = data;
+        page->entry.assign(BusInterface::PAGE_SIZE, -1);
+        page->heat.assign(BusInterface::PAGE_SIZE, 0);
+        page->code.assign(BusInterface::PAGE_SIZE, 0);
+    }
+    return page.get();
+}
+
+void Z80Jit::map_slots()
+{
+    for (int n = 0; n < BusInterface::PAGE_COUNT; n++) {
+        const uint8_t *data = _bus->read_page(n);
+        if (data == _read_ptr[n] and _bus->write_page(n) == _write_ptr[n])
+            continue;
+        _read_ptr[n] = data;
+        _write_ptr[n] = _bus->write_page(n);
+        _read_slot[n] = page_for(data);
+        // ПЗУ пишется в заглушку, код в ней не исполняется
+        _write_slot[n] = _bus->write_page(n) == data ? _read_slot[n] : nullptr;
+        _code_slot[n] = _write_slot[n] ? _write_slot[n]->code.data() : z80_jit::no_code;
+    }
+}
+
+const Z80Jit::Block * Z80Jit::lookup(uint16_t pc)
+{
+    Page *page = _read_slot[pc >> BusInterface::PAGE_SHIFT];
+    uint32_t offset = pc & BusInterface::PAGE_MASK;
+    int32_t index = page->entry[offset];
+
+    _current = page;
+    if (index >= 0)
+        return &page->blocks[index];
+    if (++page->heat[offset] < HOT_THRESHOLD)
+        return nullptr;
+    return translate(page, pc);
+}
+
+const Z80Jit::Block * Z80Jit::translate(Page *page, uint16_t pc)
+{
+    uint32_t offset = pc & BusInterface::PAGE_MASK;
+    Block block;
+
+    block.first = page->ops.size();
+    for (uint32_t at = offset; block.count < MAX_BLOCK;) {
+        int kind;
+        int length = z80_jit::decode(page->data + at, BusInterface::PAGE_SIZE - at, &kind);
+        if (length == 0 or kind == z80_jit::INTERPRET)
+            break;
+        page->ops.push_back(_table[page->data[at]]);
+        page->opcodes.push_back(page->data[at]);
+        for (int i = 0; i < length; i++)
+            page->code[at + i] = 1;
+        block.count++;
+        at += length;
+        if (kind == z80_jit::LAST)
+            break;
+    }
+
+    if (block.count)
+        _stats.translated++;
+
+#ifdef Z80_JIT_X86_64
+    if (_native and block.count) {
+        if (page->chunks.empty() or page->used + z80_jit::MAX_CODE > z80_jit::CHUNK_SIZE) {
+            zuint8 *chunk = z80_jit::alloc_code();
+            if (chunk) {
+                page->chunks.push_back(chunk);
+                page->used = 0;
+            }
+        }
+        if (not page->chunks.empty() and page->used + z80_jit::MAX_CODE <= z80_jit::CHUNK_SIZE) {
+            static const z80_jit::Offsets offsets;
+            zuint8 *code = page->chunks.back() + page->used;
+            z80_jit::Emitter out(code);
+
+            out.prologue();
+            for (uint32_t i = 0; i < block.count; i++)
+                out.instruction(offsets, page->opcodes[block.first + i],
+                                page->ops[block.first + i], i + 1 == block.count);
+            out.epilogue();
+            page->used += (out.size() + 15) & ~size_t(15);
+            block.native = reinterpret_cast<Native>(code);
+            _stats.native++;
+        }
+    }
+#endif
+
+    page->entry[offset] = page->blocks.size();
+    page->blocks.push_back(block);
+    return &page->blocks.back();
+}
+
+Z80Jit::Page::~Page()
+{
+#ifdef Z80_JIT_X86_64
+    for (zuint8 *chunk : chunks)
+        z80_jit::free_code(chunk);
+#endif
+}
+
+void Z80Jit::invalidate(Page *page)
+{
+    _stats.invalidated++;
+    std::fill(page->entry.begin(), page->entry.end(), -1);
+    std::fill(page->heat.begin(), page->heat.end(), 0);
+    std::fill(page->code.begin(), page->code.end(), 0);
+    // Сами блоки могут сейчас исполняться - освобождаем их после блока
+    page->garbage = true;
+    _garbage.push_back(page);
+    _abort = true;
+}
+
+void Z80Jit::collect()
+{
+    for (Page *page : _garbage) {
+        if (not page->garbage)
+            continue;
+        page->blocks.clear();
+        page->ops.clear();
+        page->opcodes.clear();
+        page->used = 0;
+        // Последний кусок исполняемой памяти остаётся под новые блоки
+#ifdef Z80_JIT_X86_64
+        while (page->chunks.size() > 1) {
+            z80_jit::free_code(page->chunks.back());
+            page->chunks.pop_back();
+        }
+#endif
+        page->garbage = false;
+    }
+    _garbage.clear();
+    _abort = false;
+}
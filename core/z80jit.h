@@ -0,0 +1,131 @@
+#ifndef Z80JIT_H
+#define Z80JIT_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "emulation/CPU/Z80.h"
+#include "businterface.h"
+
+// Кэш трансляции горячего кода Z80 (qmake CONFIG+=z80_jit).
+//
+// Линейные участки, которые выполнились больше HOT_THRESHOLD раз,
+// транслируются в код x86-64: прямые вызовы обработчиков из таблиц Z80.c
+// с уже подставленными опкодами, без выборки, косвенного перехода и
+// проверок прерываний на каждой инструкции. На других процессорах блок
+// хранится массивом обработчиков и исполняется тем же циклом на C++.
+// Блок заканчивается на любом переходе и EI; HALT и инструкции
+// ввода-вывода, как и весь холодный код, исполняет обычный интерпретатор,
+// поэтому такты и порядок обращений к портам остаются точными.
+//
+// Кэш ведётся на каждую физическую страницу 16К (ключ - указатель на её
+// данные), поэтому переключение банков через 7FFD ничего не сбрасывает:
+// после OUT таблица слотов просто перечитывается. Запись CPU в байт,
+// попавший в транслированный блок, сбрасывает кэш этой страницы.
+// Всё, что пишет в память в обход CPU (загрузка снапшотов, reset),
+// должно вызывать flush().
+class Z80Jit
+{
+public:
+    static constexpr int HOT_THRESHOLD = 16;
+    static constexpr int MAX_BLOCK = 64;
+
+    struct Stats
+    {
+        uint64_t translated { 0 };   // оттранслировано блоков
+        uint64_t native { 0 };       // из них в код x86-64
+        uint64_t invalidated { 0 };  // сбросов страниц из-за записи в код
+    };
+
+    explicit Z80Jit(BusInterface *bus, bool native = true);
+
+    zusize run(Z80 *cpu, zusize cycles);
+    void flush();
+
+    BusInterface * bus() const { return _bus; }
+    const Stats & stats() const { return _stats; }
+
+    // Дальше - то, что нужно циклу исполнения в z80jit.cpp
+
+    using Handler = zuint8 (*)(Z80 *);
+    using Native = void (*)(Z80 *cpu, zusize cycles, const bool *abort);
+
+    struct Block
+    {
+        uint32_t first { 0 };   // индекс первой инструкции в Page::ops
+        uint32_t count { 0 };   // 0 - участок только для интерпретатора
+        Native native { nullptr };
+    };
+
+    struct Page
+    {
+        const uint8_t *data { nullptr };
+        std::vector<int32_t> entry;   // адрес в странице -> блок, -1 нет
+        std::vector<uint8_t> heat;    // счётчики входов
+        std::vector<uint8_t> code;    // байт входит в блок
+        std::vector<Block> blocks;
+        std::vector<Handler> ops;
+        std::vector<uint8_t> opcodes;
+        std::vector<uint8_t *> chunks; // исполняемая память под Native
+        size_t used { 0 };             // занято в последнем куске
+        bool garbage { false };        // ждёт очистки после блока
+        ~Page();
+    };
+
+    const Block * lookup(uint16_t pc);
+    const Page * current() const { return _current; }
+    bool aborted() const { return _abort; }
+    const bool * abort_flag() const { return &_abort; }
+
+    uint8_t read8(uint16_t addr) const
+    { return _read_ptr[addr >> BusInterface::PAGE_SHIFT][addr & BusInterface::PAGE_MASK]; }
+    void write8(uint16_t addr, uint8_t value)
+    {
+        int slot = addr >> BusInterface::PAGE_SHIFT;
+        _bus->page_write8(addr, value);     // и карта грязных знакомест
+        if (_code_slot[slot][addr & BusInterface::PAGE_MASK])
+            invalidate(_write_slot[slot]);
+    }
+    template <class Bus>
+    void out8(uint16_t port, uint8_t value)
+    {
+        static_cast<Bus *>(_bus)->Bus::io_write8(port, value);
+        map_slots();
+    }
+
+    void collect();
+
+private:
+    static zuint32 s_int_data(void *context);
+    static void s_halt(void *context, zboolean state);
+
+    Page * page_for(const uint8_t *data);
+    void map_slots();
+    void invalidate(Page *page);
+    const Block * translate(Page *page, uint16_t pc);
+
+    BusInterface *_bus;
+    zusize (*_run)(Z80 *, zusize, Z80Jit *) { nullptr };
+    const Handler *_table { nullptr };
+    bool _native;
+    std::unordered_map<const uint8_t *, std::unique_ptr<Page>> _pages;
+    // Копия таблиц страниц шины, обновляется в map_slots()
+    const uint8_t *_read_ptr[BusInterface::PAGE_COUNT] {};
+    uint8_t *_write_ptr[BusInterface::PAGE_COUNT] {};
+    Page *_read_slot[BusInterface::PAGE_COUNT] {};
+    Page *_write_slot[BusInterface::PAGE_COUNT] {};
+    const uint8_t *_code_slot[BusInterface::PAGE_COUNT] {}; // Page::code
+    Page *_current { nullptr };
+    std::vector<Page *> _garbage;
+    bool _abort { false };
+    Stats _stats;
+
+    // Обратные вызовы машины, подменённые на время run(): context
+    // указывает на Z80Jit, int_data и halt пробрасываются сюда.
+    void *_context { nullptr };
+    zuint32 (*_int_data)(void *) { nullptr };
+    void (*_halt)(void *, zboolean) { nullptr };
+};
+
+#endif // Z80JIT_H